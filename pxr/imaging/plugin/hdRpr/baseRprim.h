@@ -68,6 +68,14 @@ protected:
         m_isVisible = sceneDelegate->GetVisible(Base::GetId());
     }
 
+    // Reports the size of geometry data this rprim keeps on the CPU side to the render stats
+    void SetResidentBytes(HdRprApi* rprApi, TfToken const& primType, size_t numBytes) {
+        if (m_residentBytes != numBytes) {
+            rprApi->UpdateResidentGeometryBytes(primType, int64_t(numBytes) - int64_t(m_residentBytes));
+            m_residentBytes = numBytes;
+        }
+    }
+
     uint32_t GetVisibilityMask() const {
         if (!m_isVisible) {
             // If Rprim is explicitly made invisible, ignore custom visibility mask
@@ -81,6 +89,7 @@ protected:
     SdfPath m_materialId;
     bool m_isVisible = false;
     uint32_t m_visibilityMask = 0;
+    size_t m_residentBytes = 0;
 };
 
 PXR_NAMESPACE_CLOSE_SCOPE
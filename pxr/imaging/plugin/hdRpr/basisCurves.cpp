@@ -20,6 +20,13 @@ limitations under the License.
 #include "pxr/imaging/rprUsd/material.h"
 #include "pxr/imaging/rprUsd/debugCodes.h"
 
+#include "pxr/base/gf/bbox3d.h"
+#include "pxr/base/work/loops.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+
 PXR_NAMESPACE_OPEN_SCOPE
 
 HdRprBasisCurves::HdRprBasisCurves(SdfPath const& id
@@ -61,6 +68,28 @@ void HdRprBasisCurves::Sync(HdSceneDelegate* sceneDelegate,
     std::map<HdInterpolation, HdPrimvarDescriptorVector> primvarDescsPerInterpolation;
 
     bool newCurve = false;
+    HdDirtyBits convertedDataDirtyBits = HdChangeTracker::Clean;
+
+    // Screen size of instanced curves is unknown, they are always rendered in full
+    bool useHairLod = rprApi->IsHairLodEnabled() && GetInstancerId().IsEmpty();
+    if (m_isSubscribedForCameraUpdates != useHairLod) {
+        if (useHairLod) {
+            rprRenderParam->SubscribeForCameraUpdates(id);
+        } else {
+            rprRenderParam->UnsubscribeFromCameraUpdates(id);
+        }
+        m_isSubscribedForCameraUpdates = useHairLod;
+    }
+
+    if (m_cpuDataReleased) {
+        // Any of these bits recreates the RPR curve, which requires the complete geometry data.
+        // The set of rendered strands depends on the camera when hair LOD is used, so the data is not released in this case
+        static constexpr HdDirtyBits kNewCurveDirtyBits = HdChangeTracker::DirtyPoints | HdChangeTracker::DirtyTopology | HdChangeTracker::DirtyWidths | HdChangeTracker::DirtyPrimvar | HdChangeTracker::DirtyTransform;
+        if ((*dirtyBits & kNewCurveDirtyBits) || useHairLod) {
+            *dirtyBits |= HdChangeTracker::DirtyPoints | HdChangeTracker::DirtyTopology | HdChangeTracker::DirtyWidths | HdChangeTracker::DirtyPrimvar;
+            m_cpuDataReleased = false;
+        }
+    }
 
     if (*dirtyBits & HdChangeTracker::DirtyPoints) {
         HdRprFillPrimvarDescsPerInterpolation(sceneDelegate, id, &primvarDescsPerInterpolation);
@@ -79,6 +108,7 @@ void HdRprBasisCurves::Sync(HdSceneDelegate* sceneDelegate,
             m_indices = m_topology.GetCurveIndices();
         }
         newCurve = true;
+        convertedDataDirtyBits |= HdChangeTracker::DirtyTopology;
     }
 
     if (*dirtyBits & HdChangeTracker::DirtyWidths) {
@@ -91,6 +121,7 @@ void HdRprBasisCurves::Sync(HdSceneDelegate* sceneDelegate,
             TF_WARN("[%s] Curve do not have widths. Fallback value is 1.0f with a constant interpolation", id.GetText());
         }
         newCurve = true;
+        convertedDataDirtyBits |= HdChangeTracker::DirtyWidths;
     }
 
     if (*dirtyBits & HdChangeTracker::DirtyMaterialId) {
@@ -119,6 +150,7 @@ void HdRprBasisCurves::Sync(HdSceneDelegate* sceneDelegate,
             m_uvs = VtVec2fArray();
         }
         newCurve = true;
+        convertedDataDirtyBits |= HdChangeTracker::DirtyPrimvar;
 
         HdRprGeometrySettings geomSettings = {};
         geomSettings.visibilityMask = kVisibleAll;
@@ -139,12 +171,36 @@ void HdRprBasisCurves::Sync(HdSceneDelegate* sceneDelegate,
         UpdateVisibility(sceneDelegate);
     }
 
+    int hairLodLevel = 0;
+    if (useHairLod) {
+        if ((*dirtyBits & (HdChangeTracker::DirtyExtent | HdChangeTracker::DirtyPoints)) || m_localBounds.IsEmpty()) {
+            m_localBounds = sceneDelegate->GetExtent(id);
+            if (m_localBounds.IsEmpty()) {
+                VtVec3fArray const& points = m_points;
+                for (auto const& point : points) {
+                    m_localBounds.UnionWith(GfVec3d(point));
+                }
+            }
+        }
+        hairLodLevel = GetHairLodLevel(rprApi);
+    }
+    if (m_hairLodLevel != hairLodLevel) {
+        m_hairLodLevel = hairLodLevel;
+        newCurve = true;
+        convertedDataDirtyBits |= HdChangeTracker::DirtyTopology;
+    }
+
     if (newCurve) {
         if (m_rprCurve) {
             rprApi->Release(m_rprCurve);
             m_rprCurve = nullptr;
         }
 
+        size_t numPrevRetainedStrands = m_numRetainedStrands;
+        size_t prevHairLodSavedBytes = m_hairLodSavedBytes;
+        m_numRetainedStrands = 0;
+        m_hairLodSavedBytes = 0;
+
         if (m_points.empty()) {
             TF_RUNTIME_ERROR("[%s] Curve could not be created: missing points", id.GetText());
         } else if (m_widths.empty()) {
@@ -180,16 +236,25 @@ void HdRprBasisCurves::Sync(HdSceneDelegate* sceneDelegate,
             }
 
             if (isLinear) {
-                m_rprCurve = CreateLinearRprCurve(rprApi);
+                m_rprCurve = CreateLinearRprCurve(rprApi, convertedDataDirtyBits);
             } else if (m_topology.GetCurveType() == HdTokens->cubic &&
                        m_topology.GetCurveBasis() == HdTokens->bezier) {
-                m_rprCurve = CreateBezierRprCurve(rprApi);
+                m_rprCurve = CreateBezierRprCurve(rprApi, convertedDataDirtyBits);
             }
 
             if (m_rprCurve && RprUsdIsLeakCheckEnabled()) {
                 rprApi->SetName(m_rprCurve, id.GetText());
             }
         }
+
+        if (!m_rprCurve) {
+            // Converted data might not match the current Hydra data
+            ReleaseConvertedData();
+        }
+
+        rprApi->UpdateHairLodStats(
+            int64_t(m_numRetainedStrands) - int64_t(numPrevRetainedStrands),
+            int64_t(m_hairLodSavedBytes) - int64_t(prevHairLodSavedBytes));
     }
 
     if (m_rprCurve) {
@@ -213,12 +278,11 @@ void HdRprBasisCurves::Sync(HdSceneDelegate* sceneDelegate,
                     }
                 }
 
+                // Pooled materials are refcounted, so the previous one has to be released
+                auto prevFallbackMaterial = m_fallbackMaterial;
                 m_fallbackMaterial = rprApi->CreateDiffuseMaterial(color);
                 rprApi->SetCurveMaterial(m_rprCurve, m_fallbackMaterial);
-
-                if (RprUsdIsLeakCheckEnabled()) {
-                    rprApi->SetName(m_fallbackMaterial, id.GetText());
-                }
+                rprApi->Release(prevFallbackMaterial);
             }
         }
 
@@ -229,14 +293,147 @@ void HdRprBasisCurves::Sync(HdSceneDelegate* sceneDelegate,
         if (newCurve || (*dirtyBits & HdChangeTracker::DirtyTransform)) {
             rprApi->SetTransform(m_rprCurve, m_transform);
         }
+
+        if (!m_cpuDataReleased && !useHairLod && rprApi->IsCpuGeometryReleaseEnabled()) {
+            ReleaseCpuData();
+        }
     }
 
+    SetResidentBytes(rprApi, HdPrimTypeTokens->basisCurves, GetResidentBytes());
+
     *dirtyBits = HdChangeTracker::Clean;
 }
 
+void HdRprBasisCurves::ReleaseCpuData() {
+    m_topology = HdBasisCurvesTopology();
+    m_indices = VtIntArray();
+    m_widths = VtFloatArray();
+    m_uvs = VtVec2fArray();
+    m_points = VtVec3fArray();
+    ReleaseConvertedData();
+
+    m_cpuDataReleased = true;
+}
+
+void HdRprBasisCurves::ReleaseConvertedData() {
+    m_rprIndices = VtIntArray();
+    m_rprSegmentPerCurve = VtIntArray();
+    m_rprRadiuses = VtFloatArray();
+    m_rprUvs = VtVec2fArray();
+    m_rprCurveChunkOffsets.clear();
+}
+
+size_t HdRprBasisCurves::GetResidentBytes() const {
+    return HdRprGetNumBytes(m_topology.GetCurveVertexCounts()) + HdRprGetNumBytes(m_indices) +
+        HdRprGetNumBytes(m_widths) + HdRprGetNumBytes(m_uvs) + HdRprGetNumBytes(m_points) +
+        HdRprGetNumBytes(m_rprIndices) + HdRprGetNumBytes(m_rprSegmentPerCurve) + HdRprGetNumBytes(m_rprRadiuses) + HdRprGetNumBytes(m_rprUvs);
+}
+
 static const int kRprNumPointsPerSegment = 4;
 
-rpr::Curve* HdRprBasisCurves::CreateLinearRprCurve(HdRprApi* rprApi) {
+namespace {
+
+// Number of Hydra curves processed by one task of the conversion
+constexpr size_t kCurveChunkSize = 4096;
+
+// Strands are kept based on a hash of their index, so the strands retained at a lower fraction
+// are a subset of the strands retained at a higher one and LOD changes do not reshuffle the strands
+bool IsStrandPruned(size_t iCurve, float retainedFraction) {
+    if (retainedFraction >= 1.0f) {
+        return false;
+    }
+
+    // MurmurHash3 finalizer
+    uint32_t h = uint32_t(iCurve);
+    h ^= h >> 16;
+    h *= 0x85ebca6b;
+    h ^= h >> 13;
+    h *= 0xc2b2ae35;
+    h ^= h >> 16;
+    return float(h >> 8) * (1.0f / (1 << 24)) >= retainedFraction;
+}
+
+// Advances the offsets past the curve, pruned strands advance only the offsets into the Hydra data
+template <typename MeasureFunc>
+bool MeasureCurve(size_t iCurve, int numVertices, float retainedFraction, MeasureFunc const& measure, HdRprCurveOffsets* offsets) {
+    if (!IsStrandPruned(iCurve, retainedFraction)) {
+        return measure(numVertices, offsets);
+    }
+
+    HdRprCurveOffsets pruned;
+    if (!measure(numVertices, &pruned)) {
+        return false;
+    }
+    offsets->vertex += pruned.vertex;
+    offsets->varying += pruned.varying;
+    offsets->prunedBytes += pruned.rprIndex * sizeof(int) + pruned.rprRadius * sizeof(float) + pruned.rprCurve * sizeof(int);
+    return true;
+}
+
+// First phase of the conversion: computes the offsets of each chunk of curves so that
+// every output buffer could be allocated with the exact size and filled in parallel.
+// measure(numVertices, &offsets) advances the offsets past the curve and returns false for corrupted curves.
+// The last element of the returned vector holds the total sizes.
+template <typename MeasureFunc>
+bool MeasureCurves(VtIntArray const& curveCounts, float retainedFraction, MeasureFunc const& measure, std::vector<HdRprCurveOffsets>* chunkOffsets) {
+    size_t numChunks = (curveCounts.size() + kCurveChunkSize - 1) / kCurveChunkSize;
+    chunkOffsets->assign(numChunks + 1, HdRprCurveOffsets{});
+
+    std::atomic<bool> isValid(true);
+    auto curveCountsData = curveCounts.cdata();
+    WorkParallelForN(numChunks,
+        [&](size_t begin, size_t end) {
+            for (size_t iChunk = begin; iChunk < end; ++iChunk) {
+                size_t curveBegin = iChunk * kCurveChunkSize;
+                size_t curveEnd = std::min(curveBegin + kCurveChunkSize, curveCounts.size());
+
+                HdRprCurveOffsets chunkSize;
+                for (size_t iCurve = curveBegin; iCurve < curveEnd; ++iCurve) {
+                    if (!MeasureCurve(iCurve, curveCountsData[iCurve], retainedFraction, measure, &chunkSize)) {
+                        isValid = false;
+                        return;
+                    }
+                }
+                (*chunkOffsets)[iChunk + 1] = chunkSize;
+            }
+        }
+    );
+
+    if (!isValid) {
+        return false;
+    }
+
+    for (size_t iChunk = 1; iChunk <= numChunks; ++iChunk) {
+        (*chunkOffsets)[iChunk].Add((*chunkOffsets)[iChunk - 1]);
+    }
+    return true;
+}
+
+// Second phase of the conversion: fill(iCurve, numVertices, offsets) writes the RPR data of the curve
+template <typename MeasureFunc, typename FillFunc>
+void FillCurves(VtIntArray const& curveCounts, std::vector<HdRprCurveOffsets> const& chunkOffsets, float retainedFraction, MeasureFunc const& measure, FillFunc const& fill) {
+    auto curveCountsData = curveCounts.cdata();
+    WorkParallelForN(chunkOffsets.size() - 1,
+        [&](size_t begin, size_t end) {
+            for (size_t iChunk = begin; iChunk < end; ++iChunk) {
+                size_t curveBegin = iChunk * kCurveChunkSize;
+                size_t curveEnd = std::min(curveBegin + kCurveChunkSize, curveCounts.size());
+
+                HdRprCurveOffsets offsets = chunkOffsets[iChunk];
+                for (size_t iCurve = curveBegin; iCurve < curveEnd; ++iCurve) {
+                    if (!IsStrandPruned(iCurve, retainedFraction)) {
+                        fill(iCurve, curveCountsData[iCurve], offsets);
+                    }
+                    MeasureCurve(iCurve, curveCountsData[iCurve], retainedFraction, measure, &offsets);
+                }
+            }
+        }
+    );
+}
+
+} // namespace anonymous
+
+rpr::Curve* HdRprBasisCurves::CreateLinearRprCurve(HdRprApi* rprApi, HdDirtyBits convertedDataDirtyBits) {
     // Each segment of USD linear curves defined by two vertices
     // For tapered curve we need to convert it to RPR representation:
     //   4 vertices and 2 radiuses per segment
@@ -250,305 +447,399 @@ rpr::Curve* HdRprBasisCurves::CreateLinearRprCurve(HdRprApi* rprApi) {
     const int kNumPointsPerSegment = 2;
     const int kVstep = strip ? 1 : 2;
 
-    VtIntArray rprIndices;
-    VtIntArray rprSegmentPerCurve;
-    VtFloatArray rprRadiuses;
-    VtVec2fArray rprUvs;
-
-    std::function<float(int, bool)> sampleTaperRadius;
-    if (isCurveTapered) {
-        if (m_widthsInterpolation == HdInterpolationVarying) {
-            sampleTaperRadius = [this](int iSegment, bool front) {
-                return 0.5f * m_widths[iSegment + (front ? 0 : 1)];
-            };
-        } else if (m_widthsInterpolation == HdInterpolationVertex) {
-            sampleTaperRadius = [=](int iSegment, bool front) {
-                return 0.5f * m_widths[iSegment * kVstep + (front ? 0 : (kNumPointsPerSegment - 1))];
-            };
-        }
-    }
+    auto getNumSegments = [=](int numVertices) {
+        int numSegments = (numVertices - (kNumPointsPerSegment - kVstep)) / kVstep;
+        if (periodic) numSegments++;
+        return numSegments;
+    };
+
+    auto getNumPaddingIndices = [](int numSegments) {
+        // RPR requires curves to consist only of segments of kRprNumPointsPerSegment length
+        auto numTrailingPoints = (numSegments * 2) % kRprNumPointsPerSegment;
+        return numTrailingPoints ? kRprNumPointsPerSegment - numTrailingPoints : 0;
+    };
+
+    // Linear curves have the same number of varying and vertex values, so only vertex offsets are tracked
+    auto measure = [=](int numVertices, HdRprCurveOffsets* offsets) {
+        if (numVertices >= 2) {
+            if (!strip && numVertices % 2 != 0) {
+                return false;
+            }
 
-    std::function<int(int)> indexSampler;
-    if (m_indices.empty()) {
-        indexSampler = [](int idx) { return idx; };
-    } else {
-        indexSampler = [this](int idx) { return m_indices.cdata()[idx]; };
-    }
+            int numSegments = getNumSegments(numVertices);
+            if (isCurveTapered) {
+                offsets->rprIndex += numSegments * 4;
+                offsets->rprRadius += numSegments * 2;
+            } else {
+                offsets->rprIndex += numSegments * 2 + getNumPaddingIndices(numSegments);
+                offsets->rprRadius++;
+            }
+            offsets->rprCurve++;
+        }
 
-    auto& curveCounts = m_topology.GetCurveVertexCounts();
-    rprSegmentPerCurve.reserve(curveCounts.size());
+        offsets->vertex += std::max(numVertices, 0);
+        return true;
+    };
 
     // Validate Hydra curve data and calculate amount of required memory.
     //
-    size_t numRadiuses = 0;
-    size_t numIndices = 0;
-    int curveSegmentOffset = 0;
-    int curveIndicesOffset = 0;
-    for (size_t iCurve = 0; iCurve < curveCounts.size(); ++iCurve) {
-        auto numVertices = curveCounts[iCurve];
-        if (numVertices < 2) {
-            continue;
-        }
+    auto& curveCounts = m_topology.GetCurveVertexCounts();
+    const float retainedFraction = GetHairLodRetainedFraction();
+
+    // Layout of the radiuses depends on whether the curve is tapered
+    if (m_rprCurveChunkOffsets.empty() || m_isRprCurveTapered != isCurveTapered) {
+        convertedDataDirtyBits |= HdChangeTracker::DirtyTopology;
+    }
+
+    if (convertedDataDirtyBits & HdChangeTracker::DirtyTopology) {
+        convertedDataDirtyBits |= HdChangeTracker::DirtyWidths | HdChangeTracker::DirtyPrimvar;
 
-        if (!strip && numVertices % 2 != 0) {
+        if (!MeasureCurves(curveCounts, retainedFraction, measure, &m_rprCurveChunkOffsets)) {
             TF_RUNTIME_ERROR("[%s] corrupted curve data: segmented linear curve should contain even number of vertices", GetId().GetText());
+            ReleaseConvertedData();
             return nullptr;
         }
 
-        int numSegments = (numVertices - (kNumPointsPerSegment - kVstep)) / kVstep;
-        if (periodic) numSegments++;
-
-        if ((m_widthsInterpolation == HdInterpolationVarying && m_widths.size() < (curveSegmentOffset + numSegments)) ||
-            (m_widthsInterpolation == HdInterpolationVertex && m_widths.size() < (curveIndicesOffset + numVertices))) {
-            TF_RUNTIME_ERROR("[%s] corrupted curve data: insufficient amount of widths", GetId().GetText());
+        auto& totals = m_rprCurveChunkOffsets.back();
+        if (!m_indices.empty() && m_indices.size() < totals.vertex) {
+            TF_RUNTIME_ERROR("[%s] corrupted curve data: insufficient amount of indices", GetId().GetText());
+            ReleaseConvertedData();
             return nullptr;
         }
 
-        if (isCurveTapered) {
-            numRadiuses += numSegments * 2;
-            numIndices += numSegments * 4;
-        } else {
-            if (m_widthsInterpolation == HdInterpolationUniform ||
-                m_widthsInterpolation == HdInterpolationConstant) {
-                ++numRadiuses;
-            }
-            numIndices += numSegments * 2;
+        m_isRprCurveTapered = isCurveTapered;
+        m_rprIndices = VtIntArray(totals.rprIndex);
+        m_rprSegmentPerCurve = VtIntArray(totals.rprCurve);
+        m_rprRadiuses = VtFloatArray(totals.rprRadius);
+    }
+
+    auto& totals = m_rprCurveChunkOffsets.back();
+    if ((convertedDataDirtyBits & HdChangeTracker::DirtyWidths) &&
+        isCurveTapered && m_widths.size() < totals.vertex) {
+        TF_RUNTIME_ERROR("[%s] corrupted curve data: insufficient amount of widths", GetId().GetText());
+        ReleaseConvertedData();
+        return nullptr;
+    }
 
-            // RPR requires curves to consist only of segments of kRprNumPointsPerSegment length
-            auto numPointsInCurve = (numVertices - 1) * 2;
-            auto numTrailingPoints = numPointsInCurve % kRprNumPointsPerSegment;
-            if (numTrailingPoints > 0) {
-                numIndices += kRprNumPointsPerSegment - numTrailingPoints;
+    GfVec2f* dstUvs = nullptr;
+    if (convertedDataDirtyBits & HdChangeTracker::DirtyPrimvar) {
+        m_rprUvs = VtVec2fArray();
+        if (!m_uvs.empty()) {
+            if (m_uvsInterpolation == HdInterpolationUniform) {
+                m_rprUvs.resize(totals.rprCurve);
+                dstUvs = m_rprUvs.data();
+            } else if (m_uvsInterpolation == HdInterpolationConstant) {
+                m_rprUvs = VtVec2fArray(totals.rprCurve, m_uvs[0]);
             }
         }
-
-        curveSegmentOffset += numSegments;
-        curveIndicesOffset += numVertices;
     }
-    rprRadiuses.reserve(numRadiuses);
-    rprIndices.reserve(numIndices);
 
-    // Convert Hydra curve data to RPR data.
+    // Convert Hydra curve data to RPR data, only the buffers which source data has changed are filled.
     //
-    curveIndicesOffset = 0;
-    for (size_t iCurve = 0; iCurve < curveCounts.size(); ++iCurve) {
-        auto numVertices = curveCounts[iCurve];
-        if (numVertices < 2) {
-            continue;
-        }
+    const bool convertTopology = (convertedDataDirtyBits & HdChangeTracker::DirtyTopology) != 0;
+    const bool convertWidths = (convertedDataDirtyBits & HdChangeTracker::DirtyWidths) != 0;
+    int const* srcIndices = m_indices.empty() ? nullptr : m_indices.cdata();
+    float const* widths = m_widths.cdata();
+    GfVec2f const* uvs = m_uvs.cdata();
+    int* dstIndices = convertTopology ? m_rprIndices.data() : nullptr;
+    int* dstSegmentPerCurve = convertTopology ? m_rprSegmentPerCurve.data() : nullptr;
+    float* dstRadiuses = convertWidths ? m_rprRadiuses.data() : nullptr;
+    const bool isWidthUniform = m_widthsInterpolation == HdInterpolationUniform;
+    // Retained strands are widened to keep the coverage of the pruned ones
+    const float radiusScale = 0.5f / retainedFraction;
+
+    if (dstIndices || dstRadiuses || dstUvs) {
+        FillCurves(curveCounts, m_rprCurveChunkOffsets, retainedFraction, measure,
+            [=](size_t iCurve, int numVertices, HdRprCurveOffsets const& offsets) {
+                if (numVertices < 2) {
+                    return;
+                }
 
-        int numSegments = (numVertices - (kNumPointsPerSegment - kVstep)) / kVstep;
-        if (periodic) numSegments++;
+                auto index = [=](size_t idx) { return srcIndices ? srcIndices[idx] : int(idx); };
 
-        if (isCurveTapered) {
-            rprSegmentPerCurve.push_back(numVertices - 1);
-            for (int iSegment = 0; iSegment < numSegments; ++iSegment) {
-                const int segmentIndicesOffset = iSegment * kVstep;
+                int numSegments = getNumSegments(numVertices);
 
-                const int i0 = indexSampler(curveIndicesOffset + segmentIndicesOffset);
-                const int i1 = indexSampler(curveIndicesOffset + (segmentIndicesOffset + 1) % numVertices);
+                if (dstIndices) {
+                    int* indices = dstIndices + offsets.rprIndex;
+                    if (isCurveTapered) {
+                        for (int iSegment = 0; iSegment < numSegments; ++iSegment) {
+                            const int segmentIndicesOffset = iSegment * kVstep;
 
-                // Each 2 vertices of USD curve corresponds to 1 tapered RPR curve segment
-                rprIndices.push_back(i0);
-                rprIndices.push_back(i0);
-                rprIndices.push_back(i1);
-                rprIndices.push_back(i1);
+                            // Each 2 vertices of USD curve corresponds to 1 tapered RPR curve segment
+                            const int i0 = index(offsets.vertex + segmentIndicesOffset);
+                            const int i1 = index(offsets.vertex + (segmentIndicesOffset + 1) % numVertices);
+                            *indices++ = i0;
+                            *indices++ = i0;
+                            *indices++ = i1;
+                            *indices++ = i1;
+                        }
 
-                // Each segment of tapered curve have 2 radiuses
-                rprRadiuses.push_back(sampleTaperRadius(iSegment, true));
-                rprRadiuses.push_back(sampleTaperRadius(iSegment, false));
-            }
-        } else {
-            for (int iSegment = 0; iSegment < numSegments; ++iSegment) {
-                const int segmentIndicesOffset = iSegment * kVstep;
+                        dstSegmentPerCurve[offsets.rprCurve] = numSegments;
+                    } else {
+                        for (int iSegment = 0; iSegment < numSegments; ++iSegment) {
+                            const int segmentIndicesOffset = iSegment * kVstep;
 
-                rprIndices.push_back(indexSampler(curveIndicesOffset + segmentIndicesOffset));
-                rprIndices.push_back(indexSampler(curveIndicesOffset + (segmentIndicesOffset + 1) % numVertices));
-            }
+                            *indices++ = index(offsets.vertex + segmentIndicesOffset);
+                            *indices++ = index(offsets.vertex + (segmentIndicesOffset + 1) % numVertices);
+                        }
 
-            // RPR requires curves to consist only of segments of kRprNumPointsPerSegment length
-            auto numPointsInCurve = (numVertices - 1) * 2;
-            auto extraPoints = numPointsInCurve % kRprNumPointsPerSegment;
-            if (extraPoints) {
-                extraPoints = kRprNumPointsPerSegment - extraPoints;
+                        // Pad the curve with its last point
+                        int numPaddingIndices = getNumPaddingIndices(numSegments);
+                        std::fill(indices, indices + numPaddingIndices, *(indices - 1));
 
-                auto lastPointIndex = indexSampler(curveIndicesOffset + numVertices - 1);
-                for (int i = 0; i < extraPoints; ++i) {
-                    rprIndices.push_back(lastPointIndex);
+                        dstSegmentPerCurve[offsets.rprCurve] = (numSegments * 2 + numPaddingIndices) / kRprNumPointsPerSegment;
+                    }
                 }
-            }
 
-            // Each cylindrical curve must have 1 radius
-            if (m_widthsInterpolation == HdInterpolationUniform) {
-                rprRadiuses.push_back(m_widths[iCurve] * 0.5f);
-            } else if (m_widthsInterpolation == HdInterpolationConstant) {
-                rprRadiuses.push_back(m_widths[0] * 0.5f);
-            }
+                if (dstRadiuses) {
+                    if (isCurveTapered) {
+                        // Each segment of tapered curve have 2 radiuses
+                        float* radiuses = dstRadiuses + offsets.rprRadius;
+                        for (int iSegment = 0; iSegment < numSegments; ++iSegment) {
+                            const int segmentIndicesOffset = iSegment * kVstep;
 
-            rprSegmentPerCurve.push_back((numPointsInCurve + extraPoints) / kRprNumPointsPerSegment);
-        }
+                            *radiuses++ = radiusScale * widths[offsets.vertex + segmentIndicesOffset];
+                            *radiuses++ = radiusScale * widths[offsets.vertex + (segmentIndicesOffset + 1) % numVertices];
+                        }
+                    } else {
+                        // Each cylindrical curve must have 1 radius
+                        dstRadiuses[offsets.rprRadius] = radiusScale * widths[isWidthUniform ? iCurve : 0];
+                    }
+                }
 
-        curveIndicesOffset += numVertices;
+                if (dstUvs) {
+                    dstUvs[offsets.rprCurve] = uvs[iCurve];
+                }
+            }
+        );
     }
 
-    if (!m_uvs.empty()) {
-        if (m_uvsInterpolation == HdInterpolationUniform) {
-            rprUvs = m_uvs;
-        } else if (m_uvsInterpolation == HdInterpolationConstant) {
-            rprUvs = VtVec2fArray(rprSegmentPerCurve.size(), m_uvs[0]);
-        }
+    auto curve = rprApi->CreateCurve(m_points, m_rprIndices, m_rprRadiuses, m_rprUvs, m_rprSegmentPerCurve);
+    if (curve) {
+        m_numRetainedStrands = totals.rprCurve;
+        m_hairLodSavedBytes = totals.prunedBytes;
     }
-
-    return rprApi->CreateCurve(m_points, rprIndices, rprRadiuses, rprUvs, rprSegmentPerCurve);
+    return curve;
 }
 
-rpr::Curve* HdRprBasisCurves::CreateBezierRprCurve(HdRprApi* rprApi) {
+rpr::Curve* HdRprBasisCurves::CreateBezierRprCurve(HdRprApi* rprApi, HdDirtyBits convertedDataDirtyBits) {
     if (m_topology.GetCurveWrap() == HdTokens->segmented) {
         TF_RUNTIME_ERROR("[%s] corrupted curve data: bezier curve can not be of segmented wrap type", GetId().GetText());
         return nullptr;
     }
 
-    VtIntArray rprIndices;
-    VtIntArray rprSegmentPerCurve;
-    VtFloatArray rprRadiuses;
-    VtVec2fArray rprUvs;
-
-    auto& curveCounts = m_topology.GetCurveVertexCounts();
-    rprSegmentPerCurve.reserve(curveCounts.size());
-
     const int kNumPointsPerSegment = 4;
     const int kVstep = 3;
 
     const bool periodic = m_topology.GetCurveWrap() == HdTokens->periodic;
     const bool isCurveTapered = m_widthsInterpolation != HdInterpolationConstant && m_widthsInterpolation != HdInterpolationUniform;
 
-    std::function<float(int, bool)> sampleTaperRadius;
-    if (isCurveTapered) {
-        if (m_widthsInterpolation == HdInterpolationVarying) {
-            sampleTaperRadius = [this](int iSegment, bool front) {
-                return 0.5f * m_widths[iSegment + (front ? 0 : 1)];
-            };
-        } else if (m_widthsInterpolation == HdInterpolationVertex) {
-            sampleTaperRadius = [=](int iSegment, bool front) {
-                return 0.5f * m_widths[iSegment * kVstep + (front ? 0 : (kNumPointsPerSegment - 1))];
-            };
+    auto getNumSegments = [=](int numVertices) {
+        int numSegments = (numVertices - (kNumPointsPerSegment - kVstep)) / kVstep;
+        if (periodic) numSegments++;
+        return numSegments;
+    };
+
+    // Varying values are defined at the segment endpoints
+    auto getNumVaryings = [=](int numSegments) {
+        return periodic ? numSegments : numSegments + 1;
+    };
+
+    auto measure = [=](int numVertices, HdRprCurveOffsets* offsets) {
+        if (numVertices >= kNumPointsPerSegment) {
+            // Validity check from the USD docs
+            if ((periodic && numVertices % kVstep != 0) ||
+                (!periodic && (numVertices - 4) % kVstep != 0)) {
+                return false;
+            }
+
+            int numSegments = getNumSegments(numVertices);
+            offsets->rprIndex += numSegments * kNumPointsPerSegment;
+            offsets->rprRadius += isCurveTapered ? numSegments * 2 : 1;
+            offsets->rprCurve++;
+            offsets->varying += getNumVaryings(numSegments);
         }
-    }
 
-    std::function<int(int)> indexSampler;
-    if (m_indices.empty()) {
-        indexSampler = [](int idx) { return idx; };
-    } else {
-        indexSampler = [this](int idx) { return m_indices.cdata()[idx]; };
-    }
+        offsets->vertex += std::max(numVertices, 0);
+        return true;
+    };
 
     // Validate Hydra curve data and calculate amount of required memory.
     //
-    size_t numRadiuses = 0;
-    size_t numIndices = 0;
-    int curveSegmentOffset = 0;
-    int curveIndicesOffset = 0;
-    for (size_t iCurve = 0; iCurve < curveCounts.size(); ++iCurve) {
-        auto numVertices = curveCounts[iCurve];
-        if (numVertices < kNumPointsPerSegment) {
-            continue;
-        }
+    auto& curveCounts = m_topology.GetCurveVertexCounts();
+    const float retainedFraction = GetHairLodRetainedFraction();
+
+    // Layout of the radiuses depends on whether the curve is tapered
+    if (m_rprCurveChunkOffsets.empty() || m_isRprCurveTapered != isCurveTapered) {
+        convertedDataDirtyBits |= HdChangeTracker::DirtyTopology;
+    }
+
+    if (convertedDataDirtyBits & HdChangeTracker::DirtyTopology) {
+        convertedDataDirtyBits |= HdChangeTracker::DirtyWidths | HdChangeTracker::DirtyPrimvar;
 
-        // Validity check from the USD docs
-        if ((periodic && numVertices % kVstep != 0) ||
-            (!periodic && (numVertices - 4) % kVstep != 0)) {
+        if (!MeasureCurves(curveCounts, retainedFraction, measure, &m_rprCurveChunkOffsets)) {
             TF_RUNTIME_ERROR("[%s] corrupted curve data: invalid topology", GetId().GetText());
+            ReleaseConvertedData();
             return nullptr;
         }
 
-        int numSegments = (numVertices - (kNumPointsPerSegment - kVstep)) / kVstep;
-        if (periodic) numSegments++;
-
-        if ((m_widthsInterpolation == HdInterpolationVarying && m_widths.size() < (curveSegmentOffset + numSegments)) ||
-            (m_widthsInterpolation == HdInterpolationVertex && m_widths.size() < (curveIndicesOffset + numVertices))) {
-            TF_RUNTIME_ERROR("[%s] corrupted curve data: insufficient amount of widths", GetId().GetText());
+        auto& totals = m_rprCurveChunkOffsets.back();
+        if (!m_indices.empty() && m_indices.size() < totals.vertex) {
+            TF_RUNTIME_ERROR("[%s] corrupted curve data: insufficient amount of indices", GetId().GetText());
+            ReleaseConvertedData();
             return nullptr;
         }
 
-        numIndices += numSegments * kNumPointsPerSegment;
-        if (isCurveTapered) {
-            numRadiuses += numSegments * 2;
-        } else {
-            if (m_widthsInterpolation == HdInterpolationUniform ||
-                m_widthsInterpolation == HdInterpolationConstant) {
-                numRadiuses++;
+        m_isRprCurveTapered = isCurveTapered;
+        m_rprIndices = VtIntArray(totals.rprIndex);
+        m_rprSegmentPerCurve = VtIntArray(totals.rprCurve);
+        m_rprRadiuses = VtFloatArray(totals.rprRadius);
+    }
+
+    auto& totals = m_rprCurveChunkOffsets.back();
+    if ((convertedDataDirtyBits & HdChangeTracker::DirtyWidths) &&
+        ((m_widthsInterpolation == HdInterpolationVarying && m_widths.size() < totals.varying) ||
+         (m_widthsInterpolation == HdInterpolationVertex && m_widths.size() < totals.vertex))) {
+        TF_RUNTIME_ERROR("[%s] corrupted curve data: insufficient amount of widths", GetId().GetText());
+        ReleaseConvertedData();
+        return nullptr;
+    }
+
+    GfVec2f* dstUvs = nullptr;
+    if (convertedDataDirtyBits & HdChangeTracker::DirtyPrimvar) {
+        m_rprUvs = VtVec2fArray();
+        if (!m_uvs.empty()) {
+            if (m_uvsInterpolation == HdInterpolationUniform) {
+                m_rprUvs.resize(totals.rprCurve);
+                dstUvs = m_rprUvs.data();
+            } else if (m_uvsInterpolation == HdInterpolationConstant) {
+                m_rprUvs = VtVec2fArray(totals.rprCurve, m_uvs[0]);
             }
         }
-
-        curveSegmentOffset += numSegments;
-        curveIndicesOffset += numVertices;
     }
-    rprRadiuses.reserve(numRadiuses);
-    rprIndices.reserve(numIndices);
 
-    // Convert Hydra curve data to RPR data.
+    // Convert Hydra curve data to RPR data, only the buffers which source data has changed are filled.
     //
-    curveIndicesOffset = 0;
-    for (size_t iCurve = 0; iCurve < curveCounts.size(); ++iCurve) {
-        auto numVertices = curveCounts[iCurve];
-        if (numVertices < kNumPointsPerSegment) {
-            continue;
-        }
+    const bool convertTopology = (convertedDataDirtyBits & HdChangeTracker::DirtyTopology) != 0;
+    const bool convertWidths = (convertedDataDirtyBits & HdChangeTracker::DirtyWidths) != 0;
+    int const* srcIndices = m_indices.empty() ? nullptr : m_indices.cdata();
+    float const* widths = m_widths.cdata();
+    GfVec2f const* uvs = m_uvs.cdata();
+    int* dstIndices = convertTopology ? m_rprIndices.data() : nullptr;
+    int* dstSegmentPerCurve = convertTopology ? m_rprSegmentPerCurve.data() : nullptr;
+    float* dstRadiuses = convertWidths ? m_rprRadiuses.data() : nullptr;
+    const bool isWidthVarying = m_widthsInterpolation == HdInterpolationVarying;
+    const bool isWidthUniform = m_widthsInterpolation == HdInterpolationUniform;
+    // Retained strands are widened to keep the coverage of the pruned ones
+    const float radiusScale = 0.5f / retainedFraction;
+
+    if (dstIndices || dstRadiuses || dstUvs) {
+        FillCurves(curveCounts, m_rprCurveChunkOffsets, retainedFraction, measure,
+            [=](size_t iCurve, int numVertices, HdRprCurveOffsets const& offsets) {
+                if (numVertices < kNumPointsPerSegment) {
+                    return;
+                }
 
-        int numSegments = (numVertices - (kNumPointsPerSegment - kVstep)) / kVstep;
-        if (periodic) numSegments++;
+                auto index = [=](size_t idx) { return srcIndices ? srcIndices[idx] : int(idx); };
 
-        rprSegmentPerCurve.push_back(numSegments);
+                int numSegments = getNumSegments(numVertices);
 
-        for (int iSegment = 0; iSegment < numSegments; ++iSegment) {
-            const int segmentIndicesOffset = iSegment * kVstep;
+                if (dstIndices) {
+                    int* indices = dstIndices + offsets.rprIndex;
+                    for (int iSegment = 0; iSegment < numSegments; ++iSegment) {
+                        const int segmentIndicesOffset = iSegment * kVstep;
 
-            const int i0 = indexSampler(curveIndicesOffset + segmentIndicesOffset + 0);
-            const int i1 = indexSampler(curveIndicesOffset + segmentIndicesOffset + 1);
-            const int i2 = indexSampler(curveIndicesOffset + segmentIndicesOffset + 2);
-            const int i3 = indexSampler(curveIndicesOffset + (segmentIndicesOffset + 3) % numVertices);
+                        *indices++ = index(offsets.vertex + segmentIndicesOffset + 0);
+                        *indices++ = index(offsets.vertex + segmentIndicesOffset + 1);
+                        *indices++ = index(offsets.vertex + segmentIndicesOffset + 2);
+                        *indices++ = index(offsets.vertex + (segmentIndicesOffset + 3) % numVertices);
+                    }
 
-            rprIndices.push_back(i0);
-            rprIndices.push_back(i1);
-            rprIndices.push_back(i2);
-            rprIndices.push_back(i3);
+                    dstSegmentPerCurve[offsets.rprCurve] = numSegments;
+                }
 
-            if (isCurveTapered) {
-                // XXX: We consciously losing data here because RPR supports only two radius samples per segment
-                rprRadiuses.push_back(sampleTaperRadius(iSegment, true));
-                rprRadiuses.push_back(sampleTaperRadius(iSegment, false));
-            }
-        }
+                if (dstRadiuses) {
+                    float* radiuses = dstRadiuses + offsets.rprRadius;
+                    if (isCurveTapered) {
+                        // XXX: We consciously losing data here because RPR supports only two radius samples per segment
+                        int numVaryings = getNumVaryings(numSegments);
+                        for (int iSegment = 0; iSegment < numSegments; ++iSegment) {
+                            if (isWidthVarying) {
+                                *radiuses++ = radiusScale * widths[offsets.varying + iSegment];
+                                *radiuses++ = radiusScale * widths[offsets.varying + (iSegment + 1) % numVaryings];
+                            } else {
+                                const int segmentIndicesOffset = iSegment * kVstep;
+                                *radiuses++ = radiusScale * widths[offsets.vertex + segmentIndicesOffset];
+                                *radiuses++ = radiusScale * widths[offsets.vertex + (segmentIndicesOffset + 3) % numVertices];
+                            }
+                        }
+                    } else {
+                        // Each cylindrical curve must have 1 radius
+                        *radiuses = radiusScale * widths[isWidthUniform ? iCurve : 0];
+                    }
+                }
 
-        if (!isCurveTapered) {
-            // Each cylindrical curve must have 1 radius
-            if (m_widthsInterpolation == HdInterpolationUniform) {
-                rprRadiuses.push_back(m_widths[iCurve] * 0.5f);
-            } else if (m_widthsInterpolation == HdInterpolationConstant) {
-                rprRadiuses.push_back(m_widths[0] * 0.5f);
+                if (dstUvs) {
+                    dstUvs[offsets.rprCurve] = uvs[iCurve];
+                }
             }
-        }
+        );
+    }
 
-        curveIndicesOffset += numVertices;
+    auto curve = rprApi->CreateCurve(m_points, m_rprIndices, m_rprRadiuses, m_rprUvs, m_rprSegmentPerCurve);
+    if (curve) {
+        m_numRetainedStrands = totals.rprCurve;
+        m_hairLodSavedBytes = totals.prunedBytes;
     }
+    return curve;
+}
 
-    if (!m_uvs.empty()) {
-        if (m_uvsInterpolation == HdInterpolationUniform) {
-            rprUvs = m_uvs;
-        } else if (m_uvsInterpolation == HdInterpolationConstant) {
-            rprUvs = VtVec2fArray(rprSegmentPerCurve.size(), m_uvs[0]);
-        }
+int HdRprBasisCurves::GetHairLodLevel(HdRprApi* rprApi) const {
+    static constexpr int kMaxHairLodLevel = 12;
+
+    auto numStrands = m_topology.GetCurveVertexCounts().size();
+    auto viewportSize = rprApi->GetViewportSize();
+    double projectedSize = rprApi->GetProjectedSize(GfBBox3d(m_localBounds, GfMatrix4d(m_transform)));
+    if (projectedSize < 0.0 || numStrands == 0 || viewportSize[0] <= 0 || viewportSize[1] <= 0) {
+        return 0;
+    }
+
+    double projectedPixels = projectedSize * std::max(viewportSize[0], viewportSize[1]);
+    double numTargetStrands = projectedPixels * projectedPixels * rprApi->GetHairLodStrandsPerPixel();
+    double level = -2.0 * std::log2(std::max(numTargetStrands / numStrands, 1e-6));
+
+    // Switch the level only when it's off by more than the margin, so small camera moves do not rebuild the curve back and forth
+    static constexpr double kHysteresis = 0.25;
+    int hairLodLevel = m_hairLodLevel;
+    if (level >= hairLodLevel + 1 + kHysteresis || level < hairLodLevel - kHysteresis) {
+        hairLodLevel = static_cast<int>(std::floor(level));
     }
 
-    return rprApi->CreateCurve(m_points, rprIndices, rprRadiuses, rprUvs, rprSegmentPerCurve);
+    return std::max(0, std::min(hairLodLevel, kMaxHairLodLevel));
+}
+
+float HdRprBasisCurves::GetHairLodRetainedFraction() const {
+    return std::exp2(-0.5f * m_hairLodLevel);
 }
 
 void HdRprBasisCurves::Finalize(HdRenderParam* renderParam) {
-    auto rprApi = static_cast<HdRprRenderParam*>(renderParam)->AcquireRprApiForEdit();
+    auto rprRenderParam = static_cast<HdRprRenderParam*>(renderParam);
+    auto rprApi = rprRenderParam->AcquireRprApiForEdit();
 
     rprApi->Release(m_rprCurve);
     m_rprCurve = nullptr;
 
+    rprApi->UpdateHairLodStats(-int64_t(m_numRetainedStrands), -int64_t(m_hairLodSavedBytes));
+    m_numRetainedStrands = 0;
+    m_hairLodSavedBytes = 0;
+
+    if (m_isSubscribedForCameraUpdates) {
+        rprRenderParam->UnsubscribeFromCameraUpdates(GetId());
+        m_isSubscribedForCameraUpdates = false;
+    }
+
+    SetResidentBytes(rprApi, HdPrimTypeTokens->basisCurves, 0);
+
     rprApi->Release(m_fallbackMaterial);
     m_fallbackMaterial = nullptr;
  
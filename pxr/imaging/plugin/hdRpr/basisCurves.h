@@ -19,6 +19,7 @@ limitations under the License.
 #include "pxr/imaging/hd/basisCurves.h"
 #include "pxr/base/gf/matrix4f.h"
 #include "pxr/base/gf/vec2f.h"
+#include "pxr/base/gf/range3d.h"
 
 namespace rpr { class Curve; }
 
@@ -29,6 +30,26 @@ class RprUsdMaterial;
 
 class HdRprMaterial;
 
+// Offsets into the Hydra and RPR curve buffers at which the data of the given curve starts
+struct HdRprCurveOffsets {
+    size_t vertex = 0;
+    size_t varying = 0;
+    size_t rprIndex = 0;
+    size_t rprRadius = 0;
+    size_t rprCurve = 0;
+    // Size of the RPR data of the strands dropped by hair LOD
+    size_t prunedBytes = 0;
+
+    void Add(HdRprCurveOffsets const& other) {
+        vertex += other.vertex;
+        varying += other.varying;
+        rprIndex += other.rprIndex;
+        rprRadius += other.rprRadius;
+        rprCurve += other.rprCurve;
+        prunedBytes += other.prunedBytes;
+    }
+};
+
 class HdRprBasisCurves : public HdRprBaseRprim<HdBasisCurves> {
 
 public:
@@ -52,8 +73,17 @@ protected:
                    HdDirtyBits* dirtyBits) override;
 
 private:
-    rpr::Curve* CreateLinearRprCurve(HdRprApi* rprApi);
-    rpr::Curve* CreateBezierRprCurve(HdRprApi* rprApi);
+    // convertedDataDirtyBits tells which of the converted buffers have to be rebuilt:
+    // DirtyTopology - indices and segment counts, DirtyWidths - radiuses, DirtyPrimvar - uvs
+    rpr::Curve* CreateLinearRprCurve(HdRprApi* rprApi, HdDirtyBits convertedDataDirtyBits);
+    rpr::Curve* CreateBezierRprCurve(HdRprApi* rprApi, HdDirtyBits convertedDataDirtyBits);
+    void ReleaseConvertedData();
+
+    int GetHairLodLevel(HdRprApi* rprApi) const;
+    float GetHairLodRetainedFraction() const;
+
+    void ReleaseCpuData();
+    size_t GetResidentBytes() const;
 
 private:
     rpr::Curve* m_rprCurve = nullptr;
@@ -68,7 +98,27 @@ private:
     VtVec3fArray m_points;
     GfMatrix4f m_transform;
 
+    // RPR curve data converted from the Hydra one, kept so that width or uv edits rebuild only the affected buffers
+    VtIntArray m_rprIndices;
+    VtIntArray m_rprSegmentPerCurve;
+    VtFloatArray m_rprRadiuses;
+    VtVec2fArray m_rprUvs;
+    // Offsets of each chunk of the converted curves, the last element holds the total sizes
+    std::vector<HdRprCurveOffsets> m_rprCurveChunkOffsets;
+    bool m_isRprCurveTapered = false;
+
     uint32_t m_visibilityMask;
+
+    // Each hair LOD level reduces the number of rendered strands by a factor of sqrt(2), zero means all strands are rendered
+    int m_hairLodLevel = 0;
+    GfRange3d m_localBounds;
+    bool m_isSubscribedForCameraUpdates = false;
+
+    size_t m_numRetainedStrands = 0;
+    size_t m_hairLodSavedBytes = 0;
+
+    // Set when CPU-side copies of the geometry were dropped after the upload
+    bool m_cpuDataReleased = false;
 };
 
 PXR_NAMESPACE_CLOSE_SCOPE
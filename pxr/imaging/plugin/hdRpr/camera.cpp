@@ -76,9 +76,15 @@ void HdRprCamera::Sync(HdSceneDelegate* sceneDelegate,
                        HdRenderParam* renderParam,
                        HdDirtyBits* dirtyBits) {
     // HdRprApi uses HdRprCamera directly, so we need to stop the render thread before changing the camera.
-    static_cast<HdRprRenderParam*>(renderParam)->AcquireRprApiForEdit();
+    auto rprRenderParam = static_cast<HdRprRenderParam*>(renderParam);
+    rprRenderParam->AcquireRprApiForEdit();
 
     m_rprDirtyBits |= *dirtyBits;
+#if PXR_VERSION >= 2102
+    bool isViewChanged = (*dirtyBits & (HdCamera::DirtyTransform | HdCamera::DirtyParams)) != 0;
+#else
+    bool isViewChanged = (*dirtyBits & (HdCamera::DirtyViewMatrix | HdCamera::DirtyProjMatrix | HdCamera::DirtyParams)) != 0;
+#endif
 
     if (*dirtyBits & HdCamera::DirtyParams) {
         SdfPath const& id = GetId();
@@ -122,6 +128,10 @@ void HdRprCamera::Sync(HdSceneDelegate* sceneDelegate,
     }
 
     HdCamera::Sync(sceneDelegate, renderParam, dirtyBits);
+
+    if (isViewChanged) {
+        rprRenderParam->CameraDidChange(sceneDelegate);
+    }
 }
 
 void HdRprCamera::Finalize(HdRenderParam* renderParam) {
@@ -12,10 +12,64 @@ limitations under the License.
 ************************************************************************/
 
 #include "field.h"
+#include "rprApi.h"
 #include "renderParam.h"
+#include "vdbGridCache.h"
+
+#include "pxr/usd/sdf/assetPath.h"
+#include "pxr/usd/usdVol/tokens.h"
+#include "pxr/base/tf/fileUtils.h"
 
 PXR_NAMESPACE_OPEN_SCOPE
 
+namespace {
+
+// Path of a file sequence element split around the frame number, e.g. "smoke.0012.vdb" -> "smoke.", 12, ".vdb"
+struct SequencePath {
+    std::string prefix;
+    std::string suffix;
+    int frame;
+    size_t numDigits;
+};
+
+bool ParseSequencePath(std::string const& filepath, SequencePath* sequencePath) {
+    static const char* kDigits = "0123456789";
+
+    auto fileNameBegin = filepath.find_last_of("/\\");
+    fileNameBegin = fileNameBegin == std::string::npos ? 0 : fileNameBegin + 1;
+
+    auto digitsEnd = filepath.find_last_of(kDigits);
+    if (digitsEnd == std::string::npos || digitsEnd < fileNameBegin) {
+        return false;
+    }
+    digitsEnd++;
+
+    auto digitsBegin = filepath.find_last_not_of(kDigits, digitsEnd - 1);
+    digitsBegin = digitsBegin == std::string::npos ? 0 : digitsBegin + 1;
+
+    // Too long to be a frame number
+    size_t numDigits = digitsEnd - digitsBegin;
+    if (numDigits > 9) {
+        return false;
+    }
+
+    sequencePath->prefix = filepath.substr(0, digitsBegin);
+    sequencePath->suffix = filepath.substr(digitsEnd);
+    sequencePath->frame = std::stoi(filepath.substr(digitsBegin, numDigits));
+    sequencePath->numDigits = numDigits;
+    return true;
+}
+
+std::string GetSequenceFramePath(SequencePath const& sequencePath, int frame) {
+    auto frameString = std::to_string(frame);
+    if (frameString.size() < sequencePath.numDigits) {
+        frameString.insert(0, sequencePath.numDigits - frameString.size(), '0');
+    }
+    return sequencePath.prefix + frameString + sequencePath.suffix;
+}
+
+} // namespace anonymous
+
 HdRprField::HdRprField(SdfPath const& id) : HdField(id) {
 
 }
@@ -26,11 +80,79 @@ void HdRprField::Sync(HdSceneDelegate* sceneDelegate,
     if (*dirtyBits & DirtyParams) {
         auto rprRenderParam = static_cast<HdRprRenderParam*>(renderParam);
         rprRenderParam->NotifyVolumesAboutFieldChange(sceneDelegate, GetId());
+
+        PrefetchNextFrames(sceneDelegate, rprRenderParam->GetVdbGridPrefetcher(), rprRenderParam->GetRprApi()->GetVolumePrefetchFrames());
     }
 
     *dirtyBits = DirtyBits::Clean;
 }
 
+void HdRprField::Finalize(HdRenderParam* renderParam) {
+    // Frames prefetched for the field are not going to be used anymore
+    static_cast<HdRprRenderParam*>(renderParam)->GetVdbGridPrefetcher()->Release(GetId());
+
+    HdField::Finalize(renderParam);
+}
+
+void HdRprField::PrefetchNextFrames(HdSceneDelegate* sceneDelegate, HdRprVdbGridPrefetcher* prefetcher, int numFrames) {
+    if (numFrames <= 0) {
+        prefetcher->Release(GetId());
+        return;
+    }
+
+    auto filePathValue = sceneDelegate->Get(GetId(), UsdVolTokens->filePath);
+    if (!filePathValue.IsHolding<SdfAssetPath>()) {
+        prefetcher->Release(GetId());
+        return;
+    }
+
+    auto& assetPath = filePathValue.UncheckedGet<SdfAssetPath>();
+    auto filepath = assetPath.GetResolvedPath().empty() ? assetPath.GetAssetPath() : assetPath.GetResolvedPath();
+
+    if (filepath == m_filepath) {
+        return;
+    }
+
+    // A digit in the file name alone does not make a sequence (e.g. "smoke_v2.vdb"),
+    // the file path has to change to another frame of the same sequence first
+    SequencePath sequencePath;
+    SequencePath prevSequencePath;
+    bool isSequence = !filepath.empty() &&
+        ParseSequencePath(filepath, &sequencePath) &&
+        ParseSequencePath(m_filepath, &prevSequencePath) &&
+        prevSequencePath.prefix == sequencePath.prefix &&
+        prevSequencePath.suffix == sequencePath.suffix &&
+        prevSequencePath.frame != sequencePath.frame;
+    m_filepath = filepath;
+
+    if (!isSequence) {
+        prefetcher->Release(GetId());
+        return;
+    }
+
+    // Follow the direction of the playback frame by frame, larger jumps come from scrubbing rather than from the playback
+    int frameStep = sequencePath.frame > prevSequencePath.frame ? 1 : -1;
+
+    // Grids prefetched for the frames left behind are released.
+    // The current frame is kept until the volume reads it
+    std::vector<std::string> framePaths = {filepath};
+    for (int i = 1; i <= numFrames; ++i) {
+        int frame = sequencePath.frame + frameStep * i;
+        if (frame < 0) {
+            break;
+        }
+
+        auto framePath = GetSequenceFramePath(sequencePath, frame);
+        if (!TfIsFile(framePath)) {
+            break;
+        }
+        framePaths.push_back(std::move(framePath));
+    }
+
+    auto fieldName = sceneDelegate->Get(GetId(), UsdVolTokens->fieldName).GetWithDefault(TfToken());
+    prefetcher->Prefetch(GetId(), fieldName.GetString(), framePaths);
+}
+
 HdDirtyBits HdRprField::GetInitialDirtyBitsMask() const {
     return DirtyBits::DirtyParams;
 }
@@ -18,6 +18,8 @@ limitations under the License.
 
 PXR_NAMESPACE_OPEN_SCOPE
 
+class HdRprVdbGridPrefetcher;
+
 class HdRprField : public HdField {
 public:
     HdRprField(SdfPath const& id);
@@ -27,7 +29,16 @@ public:
               HdRenderParam* renderParam,
               HdDirtyBits* dirtyBits) override;
 
+    void Finalize(HdRenderParam* renderParam) override;
+
     HdDirtyBits GetInitialDirtyBitsMask() const override;
+
+private:
+    void PrefetchNextFrames(HdSceneDelegate* sceneDelegate, HdRprVdbGridPrefetcher* prefetcher, int numFrames);
+
+private:
+    // Used to detect .vdb file sequences and the direction of their playback
+    std::string m_filepath;
 };
 
 PXR_NAMESPACE_CLOSE_SCOPE
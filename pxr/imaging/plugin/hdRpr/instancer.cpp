@@ -14,11 +14,14 @@ limitations under the License.
 #include "instancer.h"
 
 #include "pxr/base/gf/quatd.h"
+#include "pxr/base/gf/quatf.h"
 #include "pxr/base/gf/quath.h"
-#include "pxr/base/gf/rotation.h"
 #include "pxr/base/gf/matrix4f.h"
+#include "pxr/base/work/loops.h"
 #include "pxr/imaging/hd/sceneDelegate.h"
 
+#include <tbb/task_arena.h>
+
 PXR_NAMESPACE_OPEN_SCOPE
 
 // TODO: Use HdInstancerTokens when Houdini updates USD to 20.02
@@ -42,251 +45,386 @@ void AccumulateSampleTimes(HdTimeSampleArray<T1, C> const& in, HdTimeSampleArray
     }
 }
 
-// Apply transforms referenced by instanceIndices
-template <typename Op, typename T>
-void ApplyTransform(
-    VtValue const& allTransformsValue,
-    VtIntArray const& instanceIndices,
-    GfMatrix4d* transforms) {
-    auto& allTransforms = allTransformsValue.Get<VtArray<T>>();
-    if (allTransforms.empty()) {
-        TF_RUNTIME_ERROR("No transforms");
-        return;
-    }
+// Instance transforms are composed while the instancer lock is held.
+// The parallel work is isolated so that the waiting thread does not pick up the sync of another rprim that would wait for the same lock
+template <typename Fn>
+void IsolatedParallelForN(size_t n, Fn&& fn) {
+    tbb::this_task_arena::isolate([&]() {
+        WorkParallelForN(n, std::forward<Fn>(fn));
+    });
+}
 
-    for (size_t i = 0; i < instanceIndices.size(); ++i) {
-        transforms[i] = Op{}(allTransforms[instanceIndices[i]]) * transforms[i];
-    }
+template <typename T, typename Src>
+void ConvertPrimvarValue(VtArray<Src> const& src, VtArray<T>* out, std::true_type /* sameType */) {
+    *out = src;
 }
 
-// Apply interpolated transforms referenced by instanceIndices
-template <typename Op, typename T>
-void ApplyTransform(
-    float alpha,
-    VtValue const& allTransformsValue0,
-    VtValue const& allTransformsValue1,
-    VtIntArray const& instanceIndices,
-    GfMatrix4d* transforms) {
-    auto& allTransforms0 = allTransformsValue0.Get<VtArray<T>>();
-    auto& allTransforms1 = allTransformsValue1.Get<VtArray<T>>();
-    if (allTransforms0.empty() ||
-        allTransforms1.empty()) {
-        TF_RUNTIME_ERROR("No transforms");
-        return;
-    }
+template <typename T, typename Src>
+void ConvertPrimvarValue(VtArray<Src> const& src, VtArray<T>* out, std::false_type /* sameType */) {
+    out->resize(src.size());
+    Src const* srcData = src.cdata();
+    T* dstData = out->data();
+    IsolatedParallelForN(src.size(),
+        [srcData, dstData](size_t begin, size_t end) {
+            for (size_t i = begin; i < end; ++i) {
+                dstData[i] = T(srcData[i]);
+            }
+        }
+    );
+}
 
-    for (size_t i = 0; i < instanceIndices.size(); ++i) {
-        auto transform = HdResampleNeighbors(alpha, allTransforms0[instanceIndices[i]], allTransforms1[instanceIndices[i]]);
-        transforms[i] = Op{}(transform) * transforms[i];
+template <typename T, typename Src>
+bool ConvertPrimvarValue(VtValue const& value, VtArray<T>* out) {
+    if (!value.IsHolding<VtArray<Src>>()) {
+        return false;
     }
+
+    ConvertPrimvarValue(value.UncheckedGet<VtArray<Src>>(), out, std::is_same<T, Src>{});
+    return true;
 }
 
-template <typename Op, typename T>
-void ApplyTransform(
-    HdTimeSampleArray<VtValue, 2> const& samples,
-    VtIntArray const& instanceIndices,
-    float time,
-    GfMatrix4d* transforms) {
-
-    size_t i = 0;
-    for (; i < samples.count; ++i) {
-        if (samples.times[i] == time) {
-            // Exact time match
-            return ApplyTransform<Op, T>(samples.values[i], instanceIndices, transforms);
-        }
-        if (samples.times[i] > time) {
+// Converts primvar samples of any of SrcTypes to a single value type so that the instances can be composed by one kernel.
+// Returns no samples if the primvar has an unsupported type
+template <typename T, typename... SrcTypes>
+HdTimeSampleArray<VtArray<T>, 2> ConvertPrimvarSamples(HdTimeSampleArray<VtValue, 2> const& samples) {
+    HdTimeSampleArray<VtArray<T>, 2> ret;
+    ret.Resize(samples.count);
+    for (size_t i = 0; i < samples.count; ++i) {
+        ret.times[i] = samples.times[i];
+
+        bool converted = false;
+        (void)std::initializer_list<int>{(converted = converted || ConvertPrimvarValue<T, SrcTypes>(samples.values[i], &ret.values[i]), 0)...};
+        if (!converted) {
+            ret.Resize(0);
             break;
         }
     }
-
-    if (i == 0) {
-        // time is before the first sample.
-        return ApplyTransform<Op, T>(samples.values[0], instanceIndices, transforms);
-    } else if (i == samples.count) {
-        // time is after the last sample.
-        return ApplyTransform<Op, T>(samples.values[samples.count - 1], instanceIndices, transforms);
-    } else if (samples.times[i] == samples.times[i - 1]) {
-        // Neighboring samples have identical parameter.
-        // Arbitrarily choose a sample.
-        TF_WARN("overlapping samples at %f; using first sample", samples.times[i]);
-        return ApplyTransform<Op, T>(samples.values[i - 1], instanceIndices, transforms);
-    } else {
-        // Linear blend of neighboring samples.
-        float alpha = (samples.times[i] - time) / (samples.times[i] - samples.times[i - 1]);
-        return ApplyTransform<Op, T>(alpha, samples.values[i - 1], samples.values[i], instanceIndices, transforms);
-    }
+    return ret;
 }
 
-struct TranslateOp {
-    template <typename T>
-    GfMatrix4d operator()(T const& translate) {
-        return GfMatrix4d(1).SetTranslate(GfVec3d(translate));
-    }
-};
+// Primvar values at the given time. Values of the neighboring samples are blended per instance
+template <typename T>
+class PrimvarSample {
+public:
+    PrimvarSample(HdTimeSampleArray<VtArray<T>, 2> const& samples, float time) {
+        if (samples.count == 0) {
+            return;
+        }
+
+        size_t i = 0;
+        for (; i < samples.count; ++i) {
+            if (samples.times[i] == time) {
+                // Exact time match
+                Set(samples.values[i]);
+                return;
+            }
+            if (samples.times[i] > time) {
+                break;
+            }
+        }
 
-struct RotateOp {
-    template <typename T>
-    GfMatrix4d operator()(T const& rotate) {
-        return GfMatrix4d(1).SetRotate(GfRotation(GfQuatd(rotate)));
+        if (i == 0) {
+            // time is before the first sample.
+            Set(samples.values[0]);
+        } else if (i == samples.count) {
+            // time is after the last sample.
+            Set(samples.values[samples.count - 1]);
+        } else if (samples.times[i] == samples.times[i - 1]) {
+            // Neighboring samples have identical parameter.
+            // Arbitrarily choose a sample.
+            TF_WARN("overlapping samples at %f; using first sample", samples.times[i]);
+            Set(samples.values[i - 1]);
+        } else {
+            // Linear blend of neighboring samples.
+            m_alpha = (time - samples.times[i - 1]) / (samples.times[i] - samples.times[i - 1]);
+            Set(samples.values[i - 1]);
+            m_values1 = samples.values[i].cdata();
+            m_size = std::min(m_size, samples.values[i].size());
+        }
     }
-};
 
-struct ScaleOp {
-    template <typename T>
-    GfMatrix4d operator()(T const& scale) {
-        return GfMatrix4d(1).SetScale(GfVec3d(scale));
+    bool Has(size_t index) const {
+        return index < m_size;
     }
-};
 
-struct TransformOp {
-    GfMatrix4d const& operator()(GfMatrix4d const& transform) {
-        return transform;
+    T Get(size_t index) const {
+        if (!m_values1) {
+            return m_values0[index];
+        }
+        return HdResampleNeighbors(m_alpha, m_values0[index], m_values1[index]);
     }
 
-    GfMatrix4d operator()(GfMatrix4f const& transform) {
-        return GfMatrix4d(transform);
+private:
+    void Set(VtArray<T> const& values) {
+        m_values0 = values.cdata();
+        m_size = values.size();
     }
+
+private:
+    T const* m_values0 = nullptr;
+    T const* m_values1 = nullptr;
+    size_t m_size = 0;
+    float m_alpha = 0.0f;
 };
 
 } // namespace anonymous
 
-HdTimeSampleArray<VtMatrix4dArray, 2> HdRprInstancer::SampleInstanceTransforms(SdfPath const& prototypeId) {
+void HdRprInstancer::UpdateInstanceTransforms() {
     HdSceneDelegate *delegate = GetDelegate();
     const SdfPath &instancerId = GetId();
 
-    VtIntArray instanceIndices = delegate->GetInstanceIndices(instancerId, prototypeId);
+    std::lock_guard<std::mutex> lock(m_instanceLock);
 
-    HdTimeSampleArray<GfMatrix4d, 2> instancerXform;
-    HdTimeSampleArray<VtValue, 2> instanceXforms;
-    HdTimeSampleArray<VtValue, 2> translates;
-    HdTimeSampleArray<VtValue, 2> rotates;
-    HdTimeSampleArray<VtValue, 2> scales;
-    delegate->SampleInstancerTransform(instancerId, &instancerXform);
-    delegate->SamplePrimvar(instancerId, _tokens->instanceTransform, &instanceXforms);
-    delegate->SamplePrimvar(instancerId, _tokens->translate, &translates);
-    delegate->SamplePrimvar(instancerId, _tokens->scale, &scales);
-    delegate->SamplePrimvar(instancerId, _tokens->rotate, &rotates);
+#ifndef USE_DECOUPLED_INSTANCER
+    // Instancer is not synced by Hydra, pull the changes from the change tracker
+    HdChangeTracker& changeTracker = delegate->GetRenderIndex().GetChangeTracker();
+    if (changeTracker.GetInstancerDirtyBits(instancerId) != HdChangeTracker::Clean) {
+        m_instanceTransformsValid = false;
+        changeTracker.MarkInstancerClean(instancerId);
+    }
+#endif
+
+    if (m_instanceTransformsValid) {
+        return;
+    }
+    m_instanceTransformsValid = true;
+    m_childInstancerTransforms.clear();
+
+    HdTimeSampleArray<VtValue, 2> instanceXformValues;
+    HdTimeSampleArray<VtValue, 2> translateValues;
+    HdTimeSampleArray<VtValue, 2> rotateValues;
+    HdTimeSampleArray<VtValue, 2> scaleValues;
+    delegate->SampleInstancerTransform(instancerId, &m_instancerTransform);
+    delegate->SamplePrimvar(instancerId, _tokens->instanceTransform, &instanceXformValues);
+    delegate->SamplePrimvar(instancerId, _tokens->translate, &translateValues);
+    delegate->SamplePrimvar(instancerId, _tokens->scale, &scaleValues);
+    delegate->SamplePrimvar(instancerId, _tokens->rotate, &rotateValues);
+
+    auto instanceXforms = ConvertPrimvarSamples<GfMatrix4d, GfMatrix4d, GfMatrix4f>(instanceXformValues);
+    auto translates = ConvertPrimvarSamples<GfVec3d, GfVec3f, GfVec3d, GfVec3h>(translateValues);
+    auto rotates = ConvertPrimvarSamples<GfQuatd, GfQuath, GfQuatf, GfQuatd>(rotateValues);
+    auto scales = ConvertPrimvarSamples<GfVec3d, GfVec3f, GfVec3d, GfVec3h>(scaleValues);
 
     // Hydra might give us falsely varying instancerXform, i.e. more than one time sample with the sample matrix
     // This will lead to huge over computation in case it's the only array with a few time samples
-    if (instancerXform.count > 1) {
+    if (m_instancerTransform.count > 1) {
         size_t iSample = 1;
-        for (; iSample < instancerXform.values.size(); ++iSample) {
-            if (!GfIsClose(instancerXform.values[iSample - 1], instancerXform.values[iSample], 1e-6)) {
+        for (; iSample < m_instancerTransform.values.size(); ++iSample) {
+            if (!GfIsClose(m_instancerTransform.values[iSample - 1], m_instancerTransform.values[iSample], 1e-6)) {
                 break;
             }
         }
         // All samples the same
-        if (iSample == instancerXform.values.size()) {
-            instancerXform.Resize(1);
+        if (iSample == m_instancerTransform.values.size()) {
+            m_instancerTransform.Resize(1);
         }
     }
 
     // As a simple resampling strategy, find the input with the max #
     // of samples and use its sample placement.  In practice we expect
     // them to all be the same, i.e. to not require resampling.
-    HdTimeSampleArray<VtMatrix4dArray, 2> sa;
+    auto& sa = m_instanceTransforms;
     sa.Resize(0);
-    AccumulateSampleTimes(instancerXform, &sa);
+    AccumulateSampleTimes(m_instancerTransform, &sa);
     AccumulateSampleTimes(instanceXforms, &sa);
     AccumulateSampleTimes(translates, &sa);
     AccumulateSampleTimes(scales, &sa);
     AccumulateSampleTimes(rotates, &sa);
 
+    size_t numInstances = 0;
+    auto accumulateNumInstances = [&numInstances](auto const& samples) {
+        for (size_t i = 0; i < samples.count; ++i) {
+            numInstances = std::max(numInstances, samples.values[i].size());
+        }
+    };
+    accumulateNumInstances(instanceXforms);
+    accumulateNumInstances(translates);
+    accumulateNumInstances(scales);
+    accumulateNumInstances(rotates);
+
     for (size_t i = 0; i < sa.count; ++i) {
         const float t = sa.times[i];
 
         GfMatrix4d xf(1);
-        if (instancerXform.count > 0) {
-            xf = instancerXform.Resample(t);
+        if (m_instancerTransform.count > 0) {
+            xf = m_instancerTransform.Resample(t);
         }
+        bool applyInstancerXform = xf != GfMatrix4d(1);
+
+        PrimvarSample<GfMatrix4d> instanceXform(instanceXforms, t);
+        PrimvarSample<GfVec3d> translate(translates, t);
+        PrimvarSample<GfQuatd> rotate(rotates, t);
+        PrimvarSample<GfVec3d> scale(scales, t);
 
         auto& transforms = sa.values[i];
-        transforms = VtMatrix4dArray(instanceIndices.size(), xf);
-
-        if (translates.count > 0 && translates.values[0].IsArrayValued()) {
-            auto& type = translates.values[0].GetElementTypeid();
-            if (type == typeid(GfVec3f)) {
-                ApplyTransform<TranslateOp, GfVec3f>(translates, instanceIndices, t, transforms.data());
-            } else if (type == typeid(GfVec3d)) {
-                ApplyTransform<TranslateOp, GfVec3d>(translates, instanceIndices, t, transforms.data());
-            } else if (type == typeid(GfVec3h)) {
-                ApplyTransform<TranslateOp, GfVec3h>(translates, instanceIndices, t, transforms.data());
+        transforms.resize(numInstances);
+        GfMatrix4d* transformsData = transforms.data();
+
+        // instanceTransform * scale * rotate * translate * instancerTransform.
+        // Scale, rotate and translate are fused into a single matrix built in-place
+        IsolatedParallelForN(numInstances,
+            [&](size_t begin, size_t end) {
+                for (size_t j = begin; j < end; ++j) {
+                    GfMatrix4d transform(1);
+                    if (rotate.Has(j)) {
+                        transform.SetRotate(rotate.Get(j).GetNormalized());
+                    }
+                    if (scale.Has(j)) {
+                        GfVec3d s = scale.Get(j);
+                        for (int row = 0; row < 3; ++row) {
+                            for (int column = 0; column < 3; ++column) {
+                                transform[row][column] *= s[row];
+                            }
+                        }
+                    }
+                    if (translate.Has(j)) {
+                        GfVec3d translation = translate.Get(j);
+                        transform[3][0] = translation[0];
+                        transform[3][1] = translation[1];
+                        transform[3][2] = translation[2];
+                    }
+                    if (instanceXform.Has(j)) {
+                        transform = instanceXform.Get(j) * transform;
+                    }
+                    if (applyInstancerXform) {
+                        transform *= xf;
+                    }
+                    transformsData[j] = transform;
+                }
             }
+        );
+    }
+}
+
+HdTimeSampleArray<VtMatrix4dArray, 2> HdRprInstancer::GatherInstanceTransforms(SdfPath const& prototypeId) {
+    UpdateInstanceTransforms();
+
+    VtIntArray instanceIndices = GetDelegate()->GetInstanceIndices(GetId(), prototypeId);
+
+    // Gather composed transforms of the instances of the prototype
+    HdTimeSampleArray<VtMatrix4dArray, 2> sa;
+    sa.Resize(m_instanceTransforms.count);
+    for (size_t i = 0; i < sa.count; ++i) {
+        sa.times[i] = m_instanceTransforms.times[i];
+
+        // Instances that are not covered by instancing primvars get only the instancer transform
+        GfMatrix4d xf(1);
+        if (m_instancerTransform.count > 0) {
+            xf = m_instancerTransform.Resample(sa.times[i]);
         }
 
-        if (rotates.count > 0 && rotates.values[0].IsArrayValued()) {
-            auto& type = rotates.values[0].GetElementTypeid();
-            if (type == typeid(GfQuath)) {
-                ApplyTransform<RotateOp, GfQuath>(rotates, instanceIndices, t, transforms.data());
-            } else if (type == typeid(GfQuatf)) {
-                ApplyTransform<RotateOp, GfQuatf>(rotates, instanceIndices, t, transforms.data());
-            } else if (type == typeid(GfQuatd)) {
-                ApplyTransform<RotateOp, GfQuatd>(rotates, instanceIndices, t, transforms.data());
+        VtMatrix4dArray const& allTransforms = m_instanceTransforms.values[i];
+        GfMatrix4d const* allTransformsData = allTransforms.cdata();
+        size_t numAllTransforms = allTransforms.size();
+        int const* indices = instanceIndices.cdata();
+
+        auto& transforms = sa.values[i];
+        transforms.resize(instanceIndices.size());
+        GfMatrix4d* transformsData = transforms.data();
+        WorkParallelForN(instanceIndices.size(),
+            [&](size_t begin, size_t end) {
+                for (size_t j = begin; j < end; ++j) {
+                    int index = indices[j];
+                    transformsData[j] = (index >= 0 && size_t(index) < numAllTransforms) ? allTransformsData[index] : xf;
+                }
             }
+        );
+    }
+
+    return sa;
+}
+
+HdRprInstancer::InstanceTransformsSamplesPtr HdRprInstancer::GetChildInstancerTransforms(SdfPath const& childInstancerId) {
+    UpdateInstanceTransforms();
+
+    {
+        std::lock_guard<std::mutex> lock(m_instanceLock);
+        auto it = m_childInstancerTransforms.find(childInstancerId);
+        if (it != m_childInstancerTransforms.end()) {
+            return it->second;
         }
+    }
 
-        if (scales.count > 0 && scales.values[0].IsArrayValued()) {
-            auto& type = scales.values[0].GetElementTypeid();
-            if (type == typeid(GfVec3f)) {
-                ApplyTransform<ScaleOp, GfVec3f>(scales, instanceIndices, t, transforms.data());
-            } else if (type == typeid(GfVec3d)) {
-                ApplyTransform<ScaleOp, GfVec3d>(scales, instanceIndices, t, transforms.data());
-            } else if (type == typeid(GfVec3h)) {
-                ApplyTransform<ScaleOp, GfVec3h>(scales, instanceIndices, t, transforms.data());
-            }
+    // Gather outside of the lock, it's done in parallel
+    auto transforms = std::make_shared<HdTimeSampleArray<VtMatrix4dArray, 2>>(GatherInstanceTransforms(childInstancerId));
+
+    std::lock_guard<std::mutex> lock(m_instanceLock);
+    return m_childInstancerTransforms.emplace(childInstancerId, std::move(transforms)).first->second;
+}
+
+HdRprInstanceTransforms HdRprInstancer::SampleInstanceTransforms(SdfPath const& prototypeId) {
+    auto prototypeTransforms = GatherInstanceTransforms(prototypeId);
+
+    // Collect transforms of every nesting level, from the prototype's instancer up to the root one
+    std::vector<HdTimeSampleArray<VtMatrix4dArray, 2> const*> levels;
+    levels.push_back(&prototypeTransforms);
+
+    std::vector<InstanceTransformsSamplesPtr> parentLevels;
+    for (HdRprInstancer* instancer = this; !instancer->GetParentId().IsEmpty();) {
+        HdInstancer* parentInstancer = GetDelegate()->GetRenderIndex().GetInstancer(instancer->GetParentId());
+        if (!TF_VERIFY(parentInstancer)) {
+            break;
         }
+        auto rprParentInstancer = static_cast<HdRprInstancer*>(parentInstancer);
 
-        if (instanceXforms.count > 0 && instanceXforms.values[0].IsArrayValued()) {
-            auto& type = instanceXforms.values[0].GetElementTypeid();
-            if (type == typeid(GfMatrix4d)) {
-                ApplyTransform<TransformOp, GfMatrix4d>(instanceXforms, instanceIndices, t, transforms.data());
-            } else if (type == typeid(GfMatrix4f)) {
-                ApplyTransform<TransformOp, GfMatrix4f>(instanceXforms, instanceIndices, t, transforms.data());
-            }
+        auto parentTransforms = rprParentInstancer->GetChildInstancerTransforms(instancer->GetId());
+        if (parentTransforms->count == 0 || parentTransforms->values[0].empty()) {
+            // No samples for parent instancer.
+            break;
         }
-    }
+        parentLevels.push_back(parentTransforms);
+        levels.push_back(parentTransforms.get());
 
-    // If there is a parent instancer, continue to unroll
-    // the child instances across the parent; otherwise we're done.
-    if (GetParentId().IsEmpty()) {
-        return sa;
+        instancer = rprParentInstancer;
     }
 
-    HdInstancer *parentInstancer = GetDelegate()->GetRenderIndex().GetInstancer(GetParentId());
-    if (!TF_VERIFY(parentInstancer)) {
-        return sa;
+    // Merge sample times, taking the densest sampling.
+    HdTimeSampleArray<VtMatrix4dArray, 2> sa;
+    sa.Resize(0);
+    for (auto level : levels) {
+        AccumulateSampleTimes(*level, &sa);
     }
-    auto rprParentInstancer = static_cast<HdRprInstancer*>(parentInstancer);
 
-    // Multiply the instance samples against the parent instancer samples.
-    auto parentXf = rprParentInstancer->SampleInstanceTransforms(GetId());
-    if (parentXf.count == 0 || parentXf.values[0].empty()) {
-        // No samples for parent instancer.
-        return sa;
+    HdRprInstanceTransforms ret;
+    if (sa.count == 0) {
+        return ret;
     }
-    // Move aside previously computed child xform samples to childXf.
-    HdTimeSampleArray<VtMatrix4dArray, 2> childXf(sa);
-    // Merge sample times, taking the densest sampling.
-    AccumulateSampleTimes(parentXf, &sa);
-    // Apply parent xforms to the children.
-    for (size_t i = 0; i < sa.count; ++i) {
-        const float t = sa.times[i];
+    ret.m_times.assign(sa.times.begin(), sa.times.end());
+
+    ret.m_numInstances = 1;
+    ret.m_levels.reserve(levels.size());
+    for (auto level : levels) {
         // Resample transforms at the same time.
-        VtMatrix4dArray curParentXf = parentXf.Resample(t);
-        VtMatrix4dArray curChildXf = childXf.Resample(t);
-        // Multiply out each combination.
-        VtMatrix4dArray &result = sa.values[i];
-        result.resize(curParentXf.size() * curChildXf.size());
-        for (size_t j = 0; j < curParentXf.size(); ++j) {
-            for (size_t k = 0; k < curChildXf.size(); ++k) {
-                result[j * curChildXf.size() + k] =
-                    curChildXf[k] * curParentXf[j];
+        TfSmallVector<VtMatrix4dArray, 2> levelTransforms(ret.m_times.size());
+        for (size_t i = 0; i < ret.m_times.size(); ++i) {
+            if (level->count == sa.count && level->times[i] == ret.m_times[i]) {
+                levelTransforms[i] = level->values[i];
+            } else {
+                levelTransforms[i] = level->Resample(ret.m_times[i]);
             }
         }
+
+        ret.m_numInstances *= levelTransforms[0].size();
+        ret.m_levels.push_back(std::move(levelTransforms));
     }
 
-    return sa;
+    return ret;
+}
+
+void HdRprInstanceTransforms::Compute(size_t instanceIndex, GfMatrix4d* transforms) const {
+    for (size_t i = 0; i < m_times.size(); ++i) {
+        size_t index = instanceIndex;
+        for (size_t level = 0; level < m_levels.size(); ++level) {
+            auto& levelTransforms = m_levels[level][i];
+            size_t numLevelInstances = levelTransforms.size();
+            if (level == 0) {
+                transforms[i] = levelTransforms[index % numLevelInstances];
+            } else {
+                transforms[i] *= levelTransforms[index % numLevelInstances];
+            }
+            index /= numLevelInstances;
+        }
+    }
 }
 
 void
@@ -296,8 +434,12 @@ HdRprInstancer::Sync(HdSceneDelegate *sceneDelegate,
     HD_TRACE_FUNCTION();
     HF_MALLOC_TAG_FUNCTION();
 
-    SdfPath const& instancerId = GetId();
     _UpdateInstancer(sceneDelegate, dirtyBits);
+
+    if (*dirtyBits & (HdChangeTracker::DirtyPrimvar | HdChangeTracker::DirtyTransform | HdChangeTracker::DirtyInstanceIndex | HdChangeTracker::DirtyInstancer)) {
+        std::lock_guard<std::mutex> lock(m_instanceLock);
+        m_instanceTransformsValid = false;
+    }
 }
 
 
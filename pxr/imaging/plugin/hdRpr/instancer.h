@@ -23,13 +23,37 @@ limitations under the License.
 #include "pxr/base/gf/vec3f.h"
 #include "pxr/base/gf/vec4f.h"
 #include "pxr/base/gf/matrix4d.h"
+#include "pxr/base/tf/smallVector.h"
 
+#include <memory>
 #include <mutex>
+#include <map>
 
 PXR_NAMESPACE_OPEN_SCOPE
 
 class HdSceneDelegate;
 
+// Instance transforms of a prototype.
+// Transforms of nested instancers are not multiplied out, so the product of all nesting levels is never materialized.
+// Instead, the transform of the instance i is composed on demand as level0[i % n0] * level1[(i / n0) % n1] * ...
+class HdRprInstanceTransforms {
+public:
+    size_t GetNumInstances() const { return m_numInstances; }
+    size_t GetNumSamples() const { return m_times.size(); }
+    float const* GetSampleTimes() const { return m_times.data(); }
+
+    // Writes the transform of the instance for each time sample
+    void Compute(size_t instanceIndex, GfMatrix4d* transforms) const;
+
+private:
+    friend class HdRprInstancer;
+
+    TfSmallVector<float, 2> m_times;
+    // Transforms of each nesting level resampled at m_times, indexed as [level][sample]
+    std::vector<TfSmallVector<VtMatrix4dArray, 2>> m_levels;
+    size_t m_numInstances = 0;
+};
+
 class HdRprInstancer : public HdInstancer {
 public:
     HdRprInstancer(
@@ -39,11 +63,32 @@ public:
         HdInstancer(delegate, id HDRPR_INSTANCER_ID_ARG) {
     }
 
-    HdTimeSampleArray<VtMatrix4dArray, 2> SampleInstanceTransforms(SdfPath const& prototypeId);
+    HdRprInstanceTransforms SampleInstanceTransforms(SdfPath const& prototypeId);
 
     void Sync(HdSceneDelegate *sceneDelegate,
               HdRenderParam   *renderParam,
               HdDirtyBits     *dirtyBits) override;
+
+private:
+    // Samples instancing primvars and composes transforms of all instances if they are out of date
+    void UpdateInstanceTransforms();
+
+    HdTimeSampleArray<VtMatrix4dArray, 2> GatherInstanceTransforms(SdfPath const& prototypeId);
+
+    using InstanceTransformsSamplesPtr = std::shared_ptr<HdTimeSampleArray<VtMatrix4dArray, 2> const>;
+    // Memoized so that the prototypes of a nested instancer do not gather the same transforms over and over
+    InstanceTransformsSamplesPtr GetChildInstancerTransforms(SdfPath const& childInstancerId);
+
+    std::mutex m_instanceLock;
+    bool m_instanceTransformsValid = false;
+
+    // Composed transforms of the instances referenced by index, shared by all prototypes of the instancer.
+    // The instancer transform is included
+    HdTimeSampleArray<GfMatrix4d, 2> m_instancerTransform;
+    HdTimeSampleArray<VtMatrix4dArray, 2> m_instanceTransforms;
+
+    // Reset whenever the instance transforms are recomposed
+    std::map<SdfPath, InstanceTransformsSamplesPtr> m_childInstancerTransforms;
 };
 
 PXR_NAMESPACE_CLOSE_SCOPE
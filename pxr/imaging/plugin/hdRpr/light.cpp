@@ -169,7 +169,7 @@ rpr::Shape* HdRprLight::CreateDiskLightMesh(HdRprApi* rprApi) {
         pointIndices.push_back(centerPointIndex);
     }
 
-    return rprApi->CreateMesh(points, pointIndices, normals, normalIndices, VtVec2fArray(), VtIntArray(), vpf, HdTokens->rightHanded);
+    return rprApi->CreateLightMesh(points, pointIndices, normals, normalIndices, vpf, HdTokens->rightHanded);
 }
 
 rpr::Shape* HdRprLight::CreateRectLightMesh(HdRprApi* rprApi, bool applyTransform, GfMatrix4f const& transform) {
@@ -192,21 +192,21 @@ rpr::Shape* HdRprLight::CreateRectLightMesh(HdRprApi* rprApi, bool applyTransfor
         }
     }
 
-    return rprApi->CreateMesh(points, pointIndices, VtVec3fArray(), VtIntArray(), VtVec2fArray(), VtIntArray(), vpf, HdTokens->rightHanded);
+    return rprApi->CreateLightMesh(points, pointIndices, VtVec3fArray(), VtIntArray(), vpf, HdTokens->rightHanded);
 }
 
 rpr::Shape* HdRprLight::CreateSphereLightMesh(HdRprApi* rprApi) {
     auto& topology = UsdImagingGetUnitSphereMeshTopology();
     auto& points = UsdImagingGetUnitSphereMeshPoints();
 
-    return rprApi->CreateMesh(points, topology.GetFaceVertexIndices(), VtVec3fArray(), VtIntArray(), VtVec2fArray(), VtIntArray(), topology.GetFaceVertexCounts(), topology.GetOrientation());
+    return rprApi->CreateLightMesh(points, topology.GetFaceVertexIndices(), VtVec3fArray(), VtIntArray(), topology.GetFaceVertexCounts(), topology.GetOrientation());
 }
 
 rpr::Shape* HdRprLight::CreateCylinderLightMesh(HdRprApi* rprApi) {
     auto& topology = UsdImagingGetUnitCylinderMeshTopology();
     auto& points = UsdImagingGetUnitCylinderMeshPoints();
 
-    return rprApi->CreateMesh(points, topology.GetFaceVertexIndices(), VtVec3fArray(), VtIntArray(), VtVec2fArray(), VtIntArray(), topology.GetFaceVertexCounts(), topology.GetOrientation());
+    return rprApi->CreateLightMesh(points, topology.GetFaceVertexIndices(), VtVec3fArray(), VtIntArray(), topology.GetFaceVertexCounts(), topology.GetOrientation());
 }
 
 void HdRprLight::SyncAreaLightGeomParams(HdSceneDelegate* sceneDelegate, float* intensity) {
@@ -379,7 +379,7 @@ struct HdRprLight::LightNameSetter : public BOOST_NS::static_visitor<void> {
 
     void operator()(LightVariantEmpty) const { /*no-op*/ }
     void operator()(AreaLight* light) const {
-        rprApi->SetName(light->material, name);
+        // The material is pooled and shared with other lights, so only the meshes are named
         for (auto& mesh : light->meshes) {
             rprApi->SetName(mesh, name);
         }
@@ -16,6 +16,7 @@ limitations under the License.
 #include "renderParam.h"
 #include "material.h"
 #include "primvarUtil.h"
+#include "meshNormals.h"
 #include "rprApi.h"
 
 #include "pxr/imaging/rprUsd/material.h"
@@ -26,14 +27,72 @@ limitations under the License.
 
 #include "pxr/imaging/hd/meshUtil.h"
 #include "pxr/imaging/hd/sprim.h"
-#include "pxr/imaging/hd/smoothNormals.h"
 #include "pxr/imaging/hd/extComputationUtils.h"
 
 #include "pxr/base/gf/matrix4f.h"
 #include "pxr/base/gf/vec4f.h"
+#include "pxr/base/work/loops.h"
+
+#include <MurmurHash3.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
 
 PXR_NAMESPACE_OPEN_SCOPE
 
+TF_DEFINE_PRIVATE_TOKENS(_tokens,
+    (velocities)
+    (accelerations)
+);
+
+namespace {
+
+// Remaps indices into a dense [0; N) range. Returns the sorted unique source indices:
+//   the position of the source index in the returned list is its new index
+std::vector<int> CompactIndices(VtIntArray* indices) {
+    std::vector<int> sourceIndices(indices->cbegin(), indices->cend());
+    std::sort(sourceIndices.begin(), sourceIndices.end());
+    sourceIndices.erase(std::unique(sourceIndices.begin(), sourceIndices.end()), sourceIndices.end());
+
+    for (auto& index : *indices) {
+        index = static_cast<int>(std::lower_bound(sourceIndices.begin(), sourceIndices.end(), index) - sourceIndices.begin());
+    }
+
+    return sourceIndices;
+}
+
+template <typename T>
+bool GatherSamples(VtArray<VtArray<T>> const& samples, std::vector<int> const& sourceIndices, VtArray<VtArray<T>>* out_samples) {
+    out_samples->resize(samples.size());
+    if (samples.empty()) {
+        return true;
+    }
+
+    if (!sourceIndices.empty() && sourceIndices.front() < 0) {
+        return false;
+    }
+
+    auto outSamples = out_samples->data();
+    for (size_t iSample = 0; iSample < samples.size(); ++iSample) {
+        auto const& sample = samples.cdata()[iSample];
+        if (!sourceIndices.empty() && size_t(sourceIndices.back()) >= sample.size()) {
+            return false;
+        }
+
+        auto& outSample = outSamples[iSample];
+        outSample.resize(sourceIndices.size());
+        auto outSampleData = outSample.data();
+        for (size_t i = 0; i < sourceIndices.size(); ++i) {
+            outSampleData[i] = sample.cdata()[sourceIndices[i]];
+        }
+    }
+
+    return true;
+}
+
+} // namespace anonymous
+
 HdRprMesh::HdRprMesh(SdfPath const& id HDRPR_INSTANCER_ID_ARG_DECL)
     : HdRprBaseRprim(id HDRPR_INSTANCER_ID_ARG) {
 
@@ -60,6 +119,7 @@ HdDirtyBits HdRprMesh::GetInitialDirtyBitsMask() const {
         | HdChangeTracker::DirtyInstancer
         | HdChangeTracker::DirtyInstanceIndex
         | HdChangeTracker::DirtyDoubleSided
+        | HdChangeTracker::DirtyExtent
         ;
 
     return (HdDirtyBits)mask;
@@ -89,7 +149,6 @@ RprUsdMaterial const* HdRprMesh::GetFallbackMaterial(
         if (m_colorsSet)
         {
             m_fallbackMaterial = rprApi->CreatePrimvarColorLookupMaterial();
-            rprApi->SetName(m_fallbackMaterial, GetId().GetText());
             return m_fallbackMaterial;
         }
 
@@ -109,12 +168,87 @@ RprUsdMaterial const* HdRprMesh::GetFallbackMaterial(
         }
 
         m_fallbackMaterial = rprApi->CreateDiffuseMaterial(color);
-        rprApi->SetName(m_fallbackMaterial, GetId().GetText());
     }
 
     return m_fallbackMaterial;
 }
 
+bool HdRprMesh::DerivePointSamplesFromVelocities(
+    HdSceneDelegate* sceneDelegate,
+    HdRprApi* rprApi,
+    std::map<HdInterpolation, HdPrimvarDescriptorVector> const& primvarDescsPerInterpolation) {
+    std::vector<float> sampleTimes(m_numGeometrySamples);
+    if (!rprApi->GetDeformationSampleTimes(sampleTimes.size(), sampleTimes.data())) {
+        return false;
+    }
+
+    HdInterpolation interpolation;
+    if (!HdRprIsPrimvarExists(_tokens->velocities, primvarDescsPerInterpolation, &interpolation) ||
+        interpolation != HdInterpolationVertex) {
+        return false;
+    }
+
+    SdfPath const& id = GetId();
+    VtValue pointsValue = sceneDelegate->Get(id, HdTokens->points);
+    VtValue velocitiesValue = sceneDelegate->Get(id, _tokens->velocities);
+    if (!pointsValue.IsHolding<VtVec3fArray>() ||
+        !velocitiesValue.IsHolding<VtVec3fArray>()) {
+        return false;
+    }
+
+    auto const& points = pointsValue.UncheckedGet<VtVec3fArray>();
+    auto const& velocities = velocitiesValue.UncheckedGet<VtVec3fArray>();
+    if (velocities.size() != points.size()) {
+        TF_WARN("[%s] velocities size (%zu) does not match points size (%zu)", id.GetText(), velocities.size(), points.size());
+        return false;
+    }
+
+    VtValue accelerationsValue;
+    if (HdRprIsPrimvarExists(_tokens->accelerations, primvarDescsPerInterpolation, &interpolation) &&
+        interpolation == HdInterpolationVertex) {
+        accelerationsValue = sceneDelegate->Get(id, _tokens->accelerations);
+        if (!accelerationsValue.IsHolding<VtVec3fArray>() ||
+            accelerationsValue.UncheckedGet<VtVec3fArray>().size() != points.size()) {
+            TF_WARN("[%s] invalid accelerations primvar, ignoring", id.GetText());
+            accelerationsValue = VtValue();
+        }
+    }
+    GfVec3f const* accelerationsData = accelerationsValue.IsEmpty() ? nullptr : accelerationsValue.UncheckedGet<VtVec3fArray>().cdata();
+
+    // p(t) = p + v * t + a * t^2 / 2
+    VtArray<VtVec3fArray> pointSamples(sampleTimes.size());
+    for (size_t iSample = 0; iSample < sampleTimes.size(); ++iSample) {
+        float time = sampleTimes[iSample];
+        if (time == 0.0f) {
+            pointSamples[iSample] = points;
+            continue;
+        }
+
+        VtVec3fArray samplePoints(points.size());
+        GfVec3f* dst = samplePoints.data();
+        GfVec3f const* src = points.cdata();
+        GfVec3f const* velocitiesData = velocities.cdata();
+        float halfTimeSq = 0.5f * time * time;
+        WorkParallelForN(points.size(),
+            [=](size_t begin, size_t end) {
+                if (accelerationsData) {
+                    for (size_t i = begin; i < end; ++i) {
+                        dst[i] = src[i] + velocitiesData[i] * time + accelerationsData[i] * halfTimeSq;
+                    }
+                } else {
+                    for (size_t i = begin; i < end; ++i) {
+                        dst[i] = src[i] + velocitiesData[i] * time;
+                    }
+                }
+            }
+        );
+        pointSamples[iSample] = std::move(samplePoints);
+    }
+
+    m_pointSamples = std::move(pointSamples);
+    return true;
+}
+
 void HdRprMesh::Sync(HdSceneDelegate* sceneDelegate,
                      HdRenderParam* renderParam,
                      HdDirtyBits* dirtyBits,
@@ -127,6 +261,32 @@ void HdRprMesh::Sync(HdSceneDelegate* sceneDelegate,
 
     SdfPath const& id = GetId();
 
+    bool isTransformDirty = false;
+    if (*dirtyBits & HdChangeTracker::DirtyTransform) {
+        sceneDelegate->SampleTransform(id, &m_transformSamples);
+        isTransformDirty = true;
+    }
+
+    if (m_cpuDataReleased) {
+        // The RPR mesh can be rebuilt only from the complete geometry data, fetch all of it again
+        static constexpr HdDirtyBits kGeometryDataDirtyBits = HdChangeTracker::DirtyPoints | HdChangeTracker::DirtyTopology | HdChangeTracker::DirtyNormals | HdChangeTracker::DirtyPrimvar;
+        // Subdivision settings change the geometry itself when it's refined on the CPU.
+        // Deduplicated meshes share them with the meshes of the same content, so a new mesh is created as well
+        static constexpr HdDirtyBits kRefinedGeometryDirtyBits = HdChangeTracker::DirtyDisplayStyle | HdChangeTracker::DirtySubdivTags;
+        bool isAdaptiveRefineLevelDirty = m_isSubscribedForCameraUpdates &&
+            (*dirtyBits & (HdRprDirtyCamera | HdChangeTracker::DirtyTransform)) &&
+            GetAdaptiveRefineLevel(rprApi) != m_effectiveRefineLevel;
+        bool isSubdivisionBakedIntoMesh = m_isCpuSubdivided || rprApi->IsMeshDeduplicationEnabled();
+        // Normals that are not authored are computed from the points according to the shading mode
+        bool isFlatShadingDirty = (*dirtyBits & HdChangeTracker::DirtyDisplayStyle) &&
+            sceneDelegate->GetDisplayStyle(id).flatShadingEnabled != m_displayStyle.flatShadingEnabled;
+        if ((*dirtyBits & kGeometryDataDirtyBits) || isFlatShadingDirty ||
+            (isSubdivisionBakedIntoMesh && ((*dirtyBits & kRefinedGeometryDirtyBits) || isAdaptiveRefineLevelDirty))) {
+            *dirtyBits |= kGeometryDataDirtyBits;
+            m_cpuDataReleased = false;
+        }
+    }
+
     ////////////////////////////////////////////////////////////////////////
     // 1. Pull scene data.
 
@@ -134,9 +294,41 @@ void HdRprMesh::Sync(HdSceneDelegate* sceneDelegate,
 
     std::map<HdInterpolation, HdPrimvarDescriptorVector> primvarDescsPerInterpolation;
 
+    bool isVertexInterpolationRuleDirty = false;
+    if (*dirtyBits & HdChangeTracker::DirtySubdivTags) {
+        PxOsdSubdivTags subdivTags = sceneDelegate->GetSubdivTags(id);
+
+        // XXX: RPR does not support this
+        /*
+        auto& cornerIndices = subdivTags.GetCornerIndices();
+        auto& cornerSharpness = subdivTags.GetCornerWeights();
+        if (!cornerIndices.empty() && !cornerSharpness.empty()) {
+
+        }
+
+        auto& creaseIndices = subdivTags.GetCreaseIndices();
+        auto& creaseSharpness = subdivTags.GetCreaseWeights();
+        if (!creaseIndices.empty() && !creaseSharpness.empty()) {
+
+        }
+        */
+
+        if (m_vertexInterpolationRule != subdivTags.GetVertexInterpolationRule()) {
+            m_vertexInterpolationRule = subdivTags.GetVertexInterpolationRule();
+            isVertexInterpolationRuleDirty = true;
+        }
+    }
+
     bool isRefineLevelDirty = false;
     if (*dirtyBits & HdChangeTracker::DirtyDisplayStyle) {
+        bool wasFlatShadingEnabled = m_displayStyle.flatShadingEnabled;
         m_displayStyle = sceneDelegate->GetDisplayStyle(id);
+        if (wasFlatShadingEnabled != m_displayStyle.flatShadingEnabled && !m_authoredNormals) {
+            // Smooth normals are computed again or dropped for flat shading
+            m_normalSamples.clear();
+            m_normalsValid = false;
+            newMesh = true;
+        }
         if (m_refineLevel != m_displayStyle.refineLevel) {
             isRefineLevelDirty = true;
             m_refineLevel = m_displayStyle.refineLevel;
@@ -185,6 +377,11 @@ void HdRprMesh::Sync(HdSceneDelegate* sceneDelegate,
             m_numGeometrySamples = geomSettings.numGeometrySamples;
             *dirtyBits |= HdChangeTracker::DirtyPoints | HdChangeTracker::DirtyNormals;
         }
+
+        if (m_velocityBlur != geomSettings.velocityBlur) {
+            m_velocityBlur = geomSettings.velocityBlur;
+            *dirtyBits |= HdChangeTracker::DirtyPoints | HdChangeTracker::DirtyNormals;
+        }
     }
 
     bool pointsIsComputed = false;
@@ -241,9 +438,19 @@ void HdRprMesh::Sync(HdSceneDelegate* sceneDelegate,
         break;
     }
 
+    bool useVelocityBlur = m_velocityBlur && m_numGeometrySamples > 1;
     if (!pointsIsComputed &&
-        HdChangeTracker::IsPrimvarDirty(*dirtyBits, id, HdTokens->points)) {
-        if (!HdRprSamplePrimvar(id, HdTokens->points, sceneDelegate, m_numGeometrySamples, &m_pointSamples)) {
+        (HdChangeTracker::IsPrimvarDirty(*dirtyBits, id, HdTokens->points) ||
+         (useVelocityBlur && HdChangeTracker::IsPrimvarDirty(*dirtyBits, id, _tokens->velocities)))) {
+        // Deriving sub-frame samples from velocities avoids sampling points at every shutter time
+        bool pointsDerived = false;
+        if (useVelocityBlur) {
+            HdRprFillPrimvarDescsPerInterpolation(sceneDelegate, id, &primvarDescsPerInterpolation);
+            pointsDerived = DerivePointSamplesFromVelocities(sceneDelegate, rprApi, primvarDescsPerInterpolation);
+        }
+
+        if (!pointsDerived &&
+            !HdRprSamplePrimvar(id, HdTokens->points, sceneDelegate, m_numGeometrySamples, &m_pointSamples)) {
             m_pointSamples.clear();
         }
 
@@ -262,8 +469,20 @@ void HdRprMesh::Sync(HdSceneDelegate* sceneDelegate,
         m_faceVertexCounts = m_topology.GetFaceVertexCounts();
         m_faceVertexIndices = m_topology.GetFaceVertexIndices();
 
+        m_isLoopSubdivisionScheme = m_topology.GetScheme() == PxOsdOpenSubdivTokens->loop;
+        m_numBaseTriangles = 0;
+        m_numBaseFaceVertices = 0;
+        for (auto numVerticesInFace : m_faceVertexCounts) {
+            if (numVerticesInFace >= 3) {
+                m_numBaseTriangles += numVerticesInFace - 2;
+                m_numBaseFaceVertices += numVerticesInFace;
+            }
+        }
+
         m_adjacencyValid = false;
         m_normalsValid = false;
+        m_geomSubsetTopologiesValid = false;
+        m_rprMeshTopologies.clear();
 
         m_geomSubsets = m_topology.GetGeomSubsets();
 
@@ -345,6 +564,7 @@ void HdRprMesh::Sync(HdSceneDelegate* sceneDelegate,
             m_normalSamples.clear();
             m_normalIndices.clear();
         }
+        m_geomSubsetTopologiesValid = false;
 
         newMesh = true;
     }
@@ -439,6 +659,7 @@ void HdRprMesh::Sync(HdSceneDelegate* sceneDelegate,
                 m_uvSamples.clear();
                 m_uvIndices.clear();
             }
+            m_geomSubsetTopologiesValid = false;
 
             newMesh = true;
         }
@@ -452,7 +673,56 @@ void HdRprMesh::Sync(HdSceneDelegate* sceneDelegate,
     // 2. Resolve drawstyles
 
     m_smoothNormals = !m_displayStyle.flatShadingEnabled;
-    if (!m_authoredNormals && m_smoothNormals) {
+
+    // Screen size of instanced meshes is unknown, they always use the authored refine level
+    int refineLevel = m_refineLevel;
+    bool useAdaptiveSubdivision = m_refineLevel > 0 && rprApi->IsAdaptiveSubdivisionEnabled() && GetInstancerId().IsEmpty();
+    if (m_isSubscribedForCameraUpdates != useAdaptiveSubdivision) {
+        if (useAdaptiveSubdivision) {
+            rprRenderParam->SubscribeForCameraUpdates(id);
+        } else {
+            rprRenderParam->UnsubscribeFromCameraUpdates(id);
+        }
+        m_isSubscribedForCameraUpdates = useAdaptiveSubdivision;
+    }
+    if (useAdaptiveSubdivision) {
+        if ((*dirtyBits & (HdChangeTracker::DirtyExtent | HdChangeTracker::DirtyPoints)) || m_localBounds.IsEmpty()) {
+            m_localBounds = sceneDelegate->GetExtent(id);
+            if (m_localBounds.IsEmpty() && !m_pointSamples.empty()) {
+                for (auto const& point : m_pointSamples.cdata()[0]) {
+                    m_localBounds.UnionWith(GfVec3d(point));
+                }
+            }
+        }
+        refineLevel = GetAdaptiveRefineLevel(rprApi);
+    }
+    if (m_effectiveRefineLevel != refineLevel) {
+        m_effectiveRefineLevel = refineLevel;
+        isRefineLevelDirty = true;
+    }
+
+    bool useCpuSubdivision = m_isCpuSubdivided;
+    if (!m_cpuDataReleased) {
+        useCpuSubdivision = CanSubdivideOnCpu(rprApi);
+        if (useCpuSubdivision != m_isCpuSubdivided) {
+            newMesh = true;
+        }
+    }
+
+    if (useCpuSubdivision) {
+        if (HdChangeTracker::IsTopologyDirty(*dirtyBits, id) ||
+            (*dirtyBits & HdChangeTracker::DirtySubdivTags) ||
+            isRefineLevelDirty) {
+            m_refinedTopologyValid = false;
+            newMesh = true;
+        }
+    } else {
+        m_refinedTopology = nullptr;
+        m_refinedTopologyValid = false;
+    }
+
+    // Limit surface normals are evaluated for the meshes subdivided on the CPU
+    if (!m_authoredNormals && m_smoothNormals && !m_cpuDataReleased && !useCpuSubdivision) {
         if (!m_adjacencyValid) {
             m_adjacency.BuildAdjacencyTable(&m_topology);
             m_adjacencyValid = true;
@@ -460,22 +730,21 @@ void HdRprMesh::Sync(HdSceneDelegate* sceneDelegate,
         }
 
         if (!m_normalsValid) {
-            m_normalSamples.clear();
-            for (auto& points : m_pointSamples) {
-                m_normalSamples.push_back(Hd_SmoothNormals::ComputeSmoothNormals(&m_adjacency, points.size(), points.cdata()));
-            }
+            m_normalSamples = HdRprComputeSmoothNormals(&m_adjacency, m_pointSamples);
             m_normalsValid = true;
 
             newMesh = true;
         }
     }
 
-    bool updateTransform = newMesh;
-    if (*dirtyBits & HdChangeTracker::DirtyTransform) {
-        sceneDelegate->SampleTransform(id, &m_transformSamples);
-        updateTransform = true;
+    if (!m_cpuDataReleased && !m_rprMeshes.empty() && rprApi->IsMeshDeduplicationEnabled() &&
+        (isRefineLevelDirty || isVertexInterpolationRuleDirty)) {
+        // Subdivision settings of deduplicated meshes are changed by creating a new mesh
+        newMesh = true;
     }
 
+    bool updateTransform = newMesh || isTransformDirty;
+
     ////////////////////////////////////////////////////////////////////////
     // 3. Create RPR meshes
 
@@ -485,144 +754,191 @@ void HdRprMesh::Sync(HdSceneDelegate* sceneDelegate,
         }
         ReleaseInstances(rprApi);
         m_rprMeshes.clear();
+        m_isCpuSubdivided = useCpuSubdivision;
 
         if (m_geomSubsets.empty()) {
+            m_rprMeshTopologies.resize(1);
+
             // HybridPro will return non-nullptr mesh even in case if points are empty, it will lead to crash subsequently, so let's avoid mesh creation in case if there no vertices present.
             if (m_pointSamples.size() > 0) {
-                if (auto rprMesh = rprApi->CreateMesh(m_pointSamples, m_faceVertexIndices, m_normalSamples, m_normalIndices, m_uvSamples, m_uvIndices, m_faceVertexCounts, m_topology.GetOrientation())) {
+                if (useCpuSubdivision) {
+                    if (auto rprMesh = CreateRefinedMesh(sceneDelegate, rprApi)) {
+                        m_rprMeshes.push_back(rprMesh);
+                    }
+                } else if (auto rprMesh = rprApi->CreateMesh(m_pointSamples, m_faceVertexIndices, m_normalSamples, m_normalIndices, m_uvSamples, m_uvIndices, m_faceVertexCounts, m_topology.GetOrientation(), &m_rprMeshTopologies[0], GetMeshDataState(m_colorSamples, m_colorInterpolation))) {
                     m_colorsSet = rprApi->SetMeshVertexColor(rprMesh, m_colorSamples, m_colorInterpolation);
                     m_rprMeshes.push_back(rprMesh);
                 }
             }
         } else {
-            // GeomSubset may reference face subset in any given order so we need to be able to
-            //   randomly lookup face indexes but each face may be of an arbitrary number of vertices
-            std::vector<int> indexesOffsetPrefixSum;
-            indexesOffsetPrefixSum.reserve(m_faceVertexCounts.size());
-            int offset = 0;
-            for (auto numVerticesInFace : m_faceVertexCounts) {
-                indexesOffsetPrefixSum.push_back(offset);
-                offset += numVerticesInFace;
-            }
-
-            VtIntArray vertexIndexRemapping;
-            VtIntArray normalIndexRemapping;
-            VtIntArray uvIndexRemapping;
-
-            for (auto it = m_geomSubsets.begin(); it != m_geomSubsets.end();) {
-                auto const& subset = *it;
-                if (subset.type != HdGeomSubset::TypeFaceSet) {
-                    TF_RUNTIME_ERROR("Unknown HdGeomSubset Type");
-                    it = m_geomSubsets.erase(it);
-                    continue;
-                }
-
-                VtArray<VtVec3fArray> subsetPointSamples(m_pointSamples.size());
-                VtArray<VtVec3fArray> subsetNormalSamples(m_normalSamples.size());
-                VtArray<VtVec3fArray> subsetColorSamples(m_colorSamples.size());
-                VtArray<VtVec2fArray> subsetUvSamples(m_uvSamples.size());
-                VtIntArray subsetNormalIndices;
-                VtIntArray subsetUvIndices;
-                VtIntArray subsetIndexes;
-                VtIntArray subsetVertexPerFace;
-                subsetVertexPerFace.reserve(subset.indices.size());
-
-                vertexIndexRemapping.reserve(m_pointSamples.front().size());
-                std::fill(vertexIndexRemapping.begin(), vertexIndexRemapping.begin() + m_pointSamples.front().size(), -1);
-                if (!m_normalIndices.empty()) {
-                    normalIndexRemapping.reserve(m_normalSamples.front().size());
-                    std::fill(normalIndexRemapping.begin(), normalIndexRemapping.begin() + m_normalSamples.front().size(), -1);
-                }
-                if (!m_uvIndices.empty()) {
-                    uvIndexRemapping.reserve(m_uvSamples.front().size());
-                    std::fill(uvIndexRemapping.begin(), uvIndexRemapping.begin() + m_uvSamples.front().size(), -1);
+            // Subsets are gathered independently, so access the mesh data only through const references from the workers
+            auto const& faceVertexCounts = m_faceVertexCounts;
+            auto const& faceVertexIndices = m_faceVertexIndices;
+            auto const& normalIndices = m_normalIndices;
+            auto const& uvIndices = m_uvIndices;
+            auto const& pointSamples = m_pointSamples;
+            auto const& normalSamples = m_normalSamples;
+            auto const& colorSamples = m_colorSamples;
+            auto const& uvSamples = m_uvSamples;
+
+            const bool indexedNormals = !normalSamples.empty() && !normalIndices.empty();
+            const bool indexedUvs = !uvSamples.empty() && !uvIndices.empty();
+
+            if (!m_geomSubsetTopologiesValid ||
+                m_geomSubsetIndexedNormals != indexedNormals ||
+                m_geomSubsetIndexedUvs != indexedUvs) {
+                // GeomSubset may reference face subset in any given order so we need to be able to
+                //   randomly lookup face indexes but each face may be of an arbitrary number of vertices
+                std::vector<int> indexesOffsetPrefixSum;
+                indexesOffsetPrefixSum.reserve(m_faceVertexCounts.size());
+                int offset = 0;
+                for (auto numVerticesInFace : m_faceVertexCounts) {
+                    indexesOffsetPrefixSum.push_back(offset);
+                    offset += numVerticesInFace;
                 }
 
-                for (auto faceIndex : subset.indices) {
-                    int numVerticesInFace = m_faceVertexCounts[faceIndex];
-                    subsetVertexPerFace.push_back(numVerticesInFace);
-
-                    int faceIndexesOffset = indexesOffsetPrefixSum[faceIndex];
-
-                    for (int i = 0; i < numVerticesInFace; ++i) {
-                        const int pointIndex = m_faceVertexIndices[faceIndexesOffset + i];
-                        int subsetPointIndex = vertexIndexRemapping[pointIndex];
-
-                        bool newPoint = subsetPointIndex == -1;
-                        if (newPoint) {
-                            subsetPointIndex = static_cast<int>(subsetPointSamples.front().size());
-                            vertexIndexRemapping[pointIndex] = subsetPointIndex;
+                // Bucket faces into subsets: validate them and count the exact number of indices each subset needs
+                std::vector<size_t> subsetNumIndices;
+                subsetNumIndices.reserve(m_geomSubsets.size());
+                for (auto it = m_geomSubsets.begin(); it != m_geomSubsets.end();) {
+                    auto const& subset = *it;
+                    if (subset.type != HdGeomSubset::TypeFaceSet) {
+                        TF_RUNTIME_ERROR("Unknown HdGeomSubset Type");
+                        it = m_geomSubsets.erase(it);
+                        continue;
+                    }
 
-                            for (int sampleIndex = 0; sampleIndex < m_pointSamples.size(); ++sampleIndex) {
-                                subsetPointSamples[sampleIndex].push_back(m_pointSamples[sampleIndex][pointIndex]);
-                            }
+                    size_t numIndices = 0;
+                    bool isValid = true;
+                    for (auto faceIndex : subset.indices) {
+                        if (faceIndex < 0 || size_t(faceIndex) >= m_faceVertexCounts.size()) {
+                            isValid = false;
+                            break;
                         }
-                        subsetIndexes.push_back(subsetPointIndex);
+                        numIndices += std::max(m_faceVertexCounts[faceIndex], 0);
+                    }
+                    if (!isValid) {
+                        TF_RUNTIME_ERROR("[%s] GeomSubset %s references non-existent face", id.GetText(), subset.id.GetText());
+                        it = m_geomSubsets.erase(it);
+                        continue;
+                    }
 
-                        if (!m_normalSamples.empty()) {
-                            if (m_normalIndices.empty()) {
-                                if (newPoint) {
-                                    for (int sampleIndex = 0; sampleIndex < m_normalSamples.size(); ++sampleIndex) {
-                                        subsetNormalSamples[sampleIndex].push_back(m_normalSamples[sampleIndex][pointIndex]);
-                                    }
+                    subsetNumIndices.push_back(numIndices);
+                    ++it;
+                }
+
+                m_geomSubsetTopologies.clear();
+                m_geomSubsetTopologies.resize(m_geomSubsets.size());
+                auto const& geomSubsets = m_geomSubsets;
+
+                WorkParallelForN(geomSubsets.size(),
+                    [&](size_t begin, size_t end) {
+                        for (size_t iSubset = begin; iSubset < end; ++iSubset) {
+                            auto const& subset = geomSubsets[iSubset];
+                            auto& topology = m_geomSubsetTopologies[iSubset];
+                            const size_t numIndices = subsetNumIndices[iSubset];
+
+                            topology.vertexPerFace.resize(subset.indices.size());
+                            topology.indices.resize(numIndices);
+                            if (indexedNormals) topology.normalIndices.resize(numIndices);
+                            if (indexedUvs) topology.uvIndices.resize(numIndices);
+
+                            auto vertexPerFaceData = topology.vertexPerFace.data();
+                            auto indicesData = topology.indices.data();
+                            auto normalIndicesData = indexedNormals ? topology.normalIndices.data() : nullptr;
+                            auto uvIndicesData = indexedUvs ? topology.uvIndices.data() : nullptr;
+
+                            size_t subsetIndexesOffset = 0;
+                            for (size_t i = 0; i < subset.indices.size(); ++i) {
+                                const int faceIndex = subset.indices[i];
+                                const int numVerticesInFace = std::max(faceVertexCounts[faceIndex], 0);
+                                const int faceIndexesOffset = indexesOffsetPrefixSum[faceIndex];
+
+                                vertexPerFaceData[i] = numVerticesInFace;
+                                std::copy_n(faceVertexIndices.cdata() + faceIndexesOffset, numVerticesInFace, indicesData + subsetIndexesOffset);
+                                if (normalIndicesData) {
+                                    std::copy_n(normalIndices.cdata() + faceIndexesOffset, numVerticesInFace, normalIndicesData + subsetIndexesOffset);
                                 }
-                            } else {
-                                const int normalIndex = m_normalIndices[faceIndexesOffset + i];
-                                int subsetNormalIndex = normalIndexRemapping[normalIndex];
-                                if (subsetNormalIndex == -1) {
-                                    subsetNormalIndex = static_cast<int>(subsetNormalSamples.front().size());
-                                    normalIndexRemapping[normalIndex] = subsetNormalIndex;
-
-                                    for (int sampleIndex = 0; sampleIndex < m_normalSamples.size(); ++sampleIndex) {
-                                        subsetNormalSamples[sampleIndex].push_back(m_normalSamples[sampleIndex][normalIndex]);
-                                    }
+                                if (uvIndicesData) {
+                                    std::copy_n(uvIndices.cdata() + faceIndexesOffset, numVerticesInFace, uvIndicesData + subsetIndexesOffset);
                                 }
-                                subsetNormalIndices.push_back(subsetNormalIndex);
+                                subsetIndexesOffset += numVerticesInFace;
                             }
-                        }
 
-                        if (!m_uvSamples.empty()) {
-                            if (m_uvIndices.empty()) {
-                                if (newPoint) {
-                                    for (int sampleIndex = 0; sampleIndex < m_uvSamples.size(); ++sampleIndex) {
-                                        subsetUvSamples[sampleIndex].push_back(m_uvSamples[sampleIndex][pointIndex]);
-                                    }
-                                }
-                            } else {
-                                const int uvIndex = m_uvIndices[faceIndexesOffset + i];
-                                int subsetuvIndex = uvIndexRemapping[uvIndex];
-                                if (subsetuvIndex == -1) {
-                                    subsetuvIndex = static_cast<int>(subsetUvSamples.front().size());
-                                    uvIndexRemapping[uvIndex] = subsetuvIndex;
-
-                                    for (int sampleIndex = 0; sampleIndex < m_uvSamples.size(); ++sampleIndex) {
-                                        subsetUvSamples[sampleIndex].push_back(m_uvSamples[sampleIndex][uvIndex]);
-                                    }
-                                }
-                                subsetUvIndices.push_back(subsetuvIndex);
+                            topology.pointSourceIndices = CompactIndices(&topology.indices);
+                            if (indexedNormals) {
+                                topology.normalSourceIndices = CompactIndices(&topology.normalIndices);
+                            }
+                            if (indexedUvs) {
+                                topology.uvSourceIndices = CompactIndices(&topology.uvIndices);
                             }
                         }
+                    }
+                );
 
-                        if (!m_colorSamples.empty()) {
-                            if (newPoint) {
-                                for (int sampleIndex = 0; sampleIndex < m_uvSamples.size(); ++sampleIndex) {
-                                    if (sampleIndex >= m_colorSamples.size() || pointIndex >= m_colorSamples[sampleIndex].size()) {
-                                        TF_WARN("Failed verification sampleIndex >= m_colorSamples.size() || pointIndex >= m_colorSamples[sampleIndex].size()");
-                                        continue;
-                                    }
-                                    subsetColorSamples[sampleIndex].push_back(m_colorSamples[sampleIndex][pointIndex]);
-                                }
-                            }
+                m_geomSubsetIndexedNormals = indexedNormals;
+                m_geomSubsetIndexedUvs = indexedUvs;
+                m_geomSubsetTopologiesValid = true;
+                m_rprMeshTopologies.clear();
+            }
+
+            struct SubsetGeometry {
+                VtArray<VtVec3fArray> pointSamples;
+                VtArray<VtVec3fArray> normalSamples;
+                VtArray<VtVec3fArray> colorSamples;
+                VtArray<VtVec2fArray> uvSamples;
+                bool isValid = true;
+                bool colorsValid = true;
+            };
+            std::vector<SubsetGeometry> subsetGeometries(m_geomSubsetTopologies.size());
+
+            // Only the vertex data is gathered here, subset topology is reused until it changes
+            WorkParallelForN(subsetGeometries.size(),
+                [&](size_t begin, size_t end) {
+                    for (size_t iSubset = begin; iSubset < end; ++iSubset) {
+                        auto const& topology = m_geomSubsetTopologies[iSubset];
+                        auto& geometry = subsetGeometries[iSubset];
+
+                        geometry.isValid = GatherSamples(pointSamples, topology.pointSourceIndices, &geometry.pointSamples);
+                        geometry.isValid &= GatherSamples(normalSamples, indexedNormals ? topology.normalSourceIndices : topology.pointSourceIndices, &geometry.normalSamples);
+                        geometry.isValid &= GatherSamples(uvSamples, indexedUvs ? topology.uvSourceIndices : topology.pointSourceIndices, &geometry.uvSamples);
+
+                        if (!GatherSamples(colorSamples, topology.pointSourceIndices, &geometry.colorSamples)) {
+                            geometry.colorSamples.clear();
+                            geometry.colorsValid = false;
                         }
                     }
                 }
+            );
+
+            m_rprMeshTopologies.resize(m_geomSubsets.size());
+
+            size_t subsetIndex = 0;
+            for (auto it = m_geomSubsets.begin(); it != m_geomSubsets.end(); ++subsetIndex) {
+                auto& geometry = subsetGeometries[subsetIndex];
+                auto meshIndex = std::distance(m_geomSubsets.begin(), it);
+                auto eraseSubset = [&]() {
+                    m_geomSubsetTopologies.erase(m_geomSubsetTopologies.begin() + meshIndex);
+                    m_rprMeshTopologies.erase(m_rprMeshTopologies.begin() + meshIndex);
+                    it = m_geomSubsets.erase(it);
+                };
 
-                if (auto rprMesh = rprApi->CreateMesh(subsetPointSamples, subsetIndexes, subsetNormalSamples, subsetNormalIndices, subsetUvSamples, subsetUvIndices, subsetVertexPerFace, m_topology.GetOrientation())) {
-                    m_colorsSet = rprApi->SetMeshVertexColor(rprMesh, subsetColorSamples, m_colorInterpolation);
+                if (!geometry.isValid) {
+                    TF_RUNTIME_ERROR("[%s] GeomSubset %s references non-existent vertex data", id.GetText(), it->id.GetText());
+                    eraseSubset();
+                    continue;
+                }
+                if (!geometry.colorsValid) {
+                    TF_WARN("[%s] GeomSubset %s: display color does not match vertex count", id.GetText(), it->id.GetText());
+                }
+
+                auto& topology = m_geomSubsetTopologies[meshIndex];
+                if (auto rprMesh = rprApi->CreateMesh(geometry.pointSamples, topology.indices, geometry.normalSamples, topology.normalIndices, geometry.uvSamples, topology.uvIndices, topology.vertexPerFace, m_topology.GetOrientation(), &m_rprMeshTopologies[meshIndex], GetMeshDataState(geometry.colorSamples, m_colorInterpolation))) {
+                    m_colorsSet = rprApi->SetMeshVertexColor(rprMesh, geometry.colorSamples, m_colorInterpolation);
                     m_rprMeshes.push_back(rprMesh);
                     ++it;
                 } else {
-                    it = m_geomSubsets.erase(it);
+                    eraseSubset();
                 }
             }
         }
@@ -634,33 +950,17 @@ void HdRprMesh::Sync(HdSceneDelegate* sceneDelegate,
             rprApi->SetName(rprMesh, name);
         }
 
-        if (newMesh || (*dirtyBits & HdChangeTracker::DirtySubdivTags)) {
-            PxOsdSubdivTags subdivTags = sceneDelegate->GetSubdivTags(id);
-
-            // XXX: RPR does not support this
-            /*
-            auto& cornerIndices = subdivTags.GetCornerIndices();
-            auto& cornerSharpness = subdivTags.GetCornerWeights();
-            if (!cornerIndices.empty() && !cornerSharpness.empty()) {
-
-            }
-
-            auto& creaseIndices = subdivTags.GetCreaseIndices();
-            auto& creaseSharpness = subdivTags.GetCreaseWeights();
-            if (!creaseIndices.empty() && !creaseSharpness.empty()) {
-
-            }
-            */
-
-            auto vertexInterpolationRule = subdivTags.GetVertexInterpolationRule();
+        if (newMesh || isVertexInterpolationRuleDirty) {
             for (auto& rprMesh : m_rprMeshes) {
-                rprApi->SetMeshVertexInterpolationRule(rprMesh, vertexInterpolationRule);
+                rprApi->SetMeshVertexInterpolationRule(rprMesh, m_vertexInterpolationRule);
             }
         }
 
         if (newMesh || isRefineLevelDirty) {
+            // Meshes refined on the CPU are not subdivided by the core
+            int rprRefineLevel = m_isCpuSubdivided ? 0 : m_effectiveRefineLevel;
             for (auto& rprMesh : m_rprMeshes) {
-                rprApi->SetMeshRefineLevel(rprMesh, m_refineLevel, m_subdivisionCreaseWeight);
+                rprApi->SetMeshRefineLevel(rprMesh, rprRefineLevel, m_subdivisionCreaseWeight);
             }
         }
 
@@ -726,33 +1026,12 @@ void HdRprMesh::Sync(HdSceneDelegate* sceneDelegate,
             m_instancer = static_cast<HdRprInstancer*>(sceneDelegate->GetRenderIndex().GetInstancer(GetInstancerId()));
             if (m_instancer) {
                 auto instanceTransforms = m_instancer->SampleInstanceTransforms(id);
-                auto newNumInstances = (instanceTransforms.count > 0) ? instanceTransforms.values[0].size() : 0;
+                auto newNumInstances = instanceTransforms.GetNumInstances();
                 if (newNumInstances == 0) {
                     ReleaseInstances(rprApi);
                 } else {
                     updateTransform = false;
 
-                    std::vector<TfSmallVector<GfMatrix4d, 2>> combinedTransforms;
-                    combinedTransforms.reserve(newNumInstances);
-                    for (size_t i = 0; i < newNumInstances; ++i) {
-                        // Convert transform
-                        // Apply prototype transform (m_transformSamples) to all the instances
-                        combinedTransforms.emplace_back(instanceTransforms.count);
-                        auto& instanceTransform = combinedTransforms.back();
-
-                        if (m_transformSamples.count == 0 ||
-                            (m_transformSamples.count == 1 && (m_transformSamples.values[0] == GfMatrix4d(1)))) {
-                            for (size_t j = 0; j < instanceTransforms.count; ++j) {
-                                instanceTransform[j] = instanceTransforms.values[j][i];
-                            }
-                        } else {
-                            for (size_t j = 0; j < instanceTransforms.count; ++j) {
-                                GfMatrix4d xf_j = m_transformSamples.Resample(instanceTransforms.times[j]);
-                                instanceTransform[j] = xf_j * instanceTransforms.values[j][i];
-                            }
-                        }
-                    }
-
                     // Release excessive mesh instances if any
                     for (size_t i = m_rprMeshes.size(); i < m_rprMeshInstances.size(); ++i) {
                         for (auto instance : m_rprMeshInstances[i]) {
@@ -762,8 +1041,11 @@ void HdRprMesh::Sync(HdSceneDelegate* sceneDelegate,
 
                     m_rprMeshInstances.resize(m_rprMeshes.size());
 
+                    // Instances that existed before this sync have the transforms recorded in m_instanceTransformHashes
+                    std::vector<size_t> numPreviousInstances(m_rprMeshes.size());
                     for (int i = 0; i < m_rprMeshes.size(); ++i) {
                         auto& meshInstances = m_rprMeshInstances[i];
+                        numPreviousInstances[i] = std::min(meshInstances.size(), newNumInstances);
                         if (meshInstances.size() != newNumInstances) {
                             if (meshInstances.size() > newNumInstances) {
                                 for (size_t i = newNumInstances; i < meshInstances.size(); ++i) {
@@ -771,16 +1053,96 @@ void HdRprMesh::Sync(HdSceneDelegate* sceneDelegate,
                                 }
                                 meshInstances.resize(newNumInstances);
                             } else {
-                                for (int j = meshInstances.size(); j < newNumInstances; ++j) {
-                                    meshInstances.push_back(rprApi->CreateMeshInstance(m_rprMeshes[i]));
+                                auto newInstances = rprApi->CreateMeshInstances(m_rprMeshes[i], newNumInstances - meshInstances.size());
+                                meshInstances.insert(meshInstances.end(), newInstances.begin(), newInstances.end());
+                                // Keep the instance count consistent across the meshes even if some instances failed to create
+                                meshInstances.resize(newNumInstances, nullptr);
+                            }
+                        }
+                    }
+
+                    // Apply prototype transform (m_transformSamples) to all the instances
+                    size_t numSamples = instanceTransforms.GetNumSamples();
+                    float const* sampleTimes = instanceTransforms.GetSampleTimes();
+                    bool applyPrototypeTransform = !(m_transformSamples.count == 0 ||
+                        (m_transformSamples.count == 1 && (m_transformSamples.values[0] == GfMatrix4d(1))));
+                    TfSmallVector<GfMatrix4d, 2> prototypeTransforms(numSamples);
+                    if (applyPrototypeTransform) {
+                        for (size_t j = 0; j < numSamples; ++j) {
+                            prototypeTransforms[j] = m_transformSamples.Resample(sampleTimes[j]);
+                        }
+                    }
+
+                    // Sample times are part of the uploaded transforms, a change of them must invalidate all instances
+                    uint32_t sampleTimesHash;
+                    MurmurHash3_x86_32(sampleTimes, int(numSamples * sizeof(float)), 0, &sampleTimesHash);
+
+                    m_instanceTransformHashes.resize(newNumInstances, 0);
+                    size_t numUpdatedTransforms = 0;
+                    size_t numSkippedTransforms = 0;
+
+                    // Transforms are composed chunk by chunk so that nested instancers with a huge number of instances
+                    // never need all of them in memory at once
+                    static constexpr size_t kInstanceChunkSize = 4096;
+                    std::vector<GfMatrix4d> chunkTransforms(std::min(newNumInstances, kInstanceChunkSize) * numSamples);
+                    std::vector<uint8_t> chunkTransformChanged(std::min(newNumInstances, kInstanceChunkSize));
+                    std::vector<GfMatrix4d> changedTransforms;
+                    std::vector<size_t> changedInstances;
+                    std::vector<rpr::Shape*> changedShapes;
+                    for (size_t chunkBegin = 0; chunkBegin < newNumInstances; chunkBegin += kInstanceChunkSize) {
+                        size_t chunkEnd = std::min(chunkBegin + kInstanceChunkSize, newNumInstances);
+                        size_t chunkSize = chunkEnd - chunkBegin;
+
+                        WorkParallelForN(chunkSize,
+                            [&](size_t begin, size_t end) {
+                                for (size_t j = begin; j < end; ++j) {
+                                    GfMatrix4d* transforms = &chunkTransforms[j * numSamples];
+                                    instanceTransforms.Compute(chunkBegin + j, transforms);
+                                    if (applyPrototypeTransform) {
+                                        for (size_t k = 0; k < numSamples; ++k) {
+                                            transforms[k] = prototypeTransforms[k] * transforms[k];
+                                        }
+                                    }
+
+                                    uint64_t hash[2];
+                                    MurmurHash3_x64_128(transforms, int(numSamples * sizeof(GfMatrix4d)), sampleTimesHash, hash);
+                                    chunkTransformChanged[j] = m_instanceTransformHashes[chunkBegin + j] != hash[0];
+                                    m_instanceTransformHashes[chunkBegin + j] = hash[0];
                                 }
                             }
+                        );
+
+                        changedInstances.clear();
+                        changedTransforms.clear();
+                        for (size_t j = 0; j < chunkSize; ++j) {
+                            if (chunkTransformChanged[j]) {
+                                changedInstances.push_back(j);
+                                changedTransforms.insert(changedTransforms.end(), &chunkTransforms[j * numSamples], &chunkTransforms[(j + 1) * numSamples]);
+                            }
                         }
 
-                        for (int j = 0; j < newNumInstances; ++j) {
-                            rprApi->SetTransform(meshInstances[j], instanceTransforms.count, instanceTransforms.times.data(), combinedTransforms[j].data());
+                        for (size_t i = 0; i < m_rprMeshInstances.size(); ++i) {
+                            auto meshInstances = m_rprMeshInstances[i].data() + chunkBegin;
+                            if (numPreviousInstances[i] < chunkEnd || changedInstances.size() == chunkSize) {
+                                // The chunk has instances created by this sync, upload all of it
+                                rprApi->SetTransforms(meshInstances, chunkSize, numSamples, sampleTimes, chunkTransforms.data());
+                                numUpdatedTransforms += chunkSize;
+                                continue;
+                            }
+
+                            if (!changedInstances.empty()) {
+                                changedShapes.clear();
+                                for (auto j : changedInstances) {
+                                    changedShapes.push_back(meshInstances[j]);
+                                }
+                                rprApi->SetTransforms(changedShapes.data(), changedShapes.size(), numSamples, sampleTimes, changedTransforms.data());
+                            }
+                            numUpdatedTransforms += changedInstances.size();
+                            numSkippedTransforms += chunkSize - changedInstances.size();
                         }
                     }
+
+                    rprApi->UpdateInstanceTransformStats(numUpdatedTransforms, numSkippedTransforms);
                 }
             } else {
                 ReleaseInstances(rprApi);
@@ -796,9 +1158,7 @@ void HdRprMesh::Sync(HdSceneDelegate* sceneDelegate,
                 }
                 // Instances visibility controlled by the user
                 for (auto& instances : m_rprMeshInstances) {
-                    for (auto& rprMesh : instances) {
-                        rprApi->SetMeshVisibility(rprMesh, visibilityMask);
-                    }
+                    rprApi->SetMeshVisibility(instances.data(), instances.size(), visibilityMask);
                 }
             } else {
                 for (auto& rprMesh : m_rprMeshes) {
@@ -813,9 +1173,7 @@ void HdRprMesh::Sync(HdSceneDelegate* sceneDelegate,
                 rprApi->SetMeshId(rprMesh, id);
             }
             for (auto& instances : m_rprMeshInstances) {
-                for (int instanceNum = 0; instanceNum < instances.size(); instanceNum++) {
-                    rprApi->SetMeshId(instances[instanceNum], instanceNum);
-                } 
+                rprApi->SetMeshIds(instances.data(), instances.size(), 0);
             }
         }
 
@@ -830,11 +1188,208 @@ void HdRprMesh::Sync(HdSceneDelegate* sceneDelegate,
                 rprApi->SetTransform(rprMesh, m_transformSamples.count, m_transformSamples.times.data(), m_transformSamples.values.data());
             }
         }
+
+        if (!m_cpuDataReleased && rprApi->IsCpuGeometryReleaseEnabled()) {
+            ReleaseCpuData();
+        }
+    }
+
+    SetResidentBytes(rprApi, HdPrimTypeTokens->mesh, GetResidentBytes());
+
+    size_t numRefinedTriangles = GetNumRefinedTriangles();
+    if (m_numRefinedTriangles != numRefinedTriangles) {
+        rprApi->UpdateRefinedTriangleCount(int64_t(numRefinedTriangles) - int64_t(m_numRefinedTriangles));
+        m_numRefinedTriangles = numRefinedTriangles;
     }
 
     *dirtyBits = HdChangeTracker::Clean;
 }
 
+int HdRprMesh::GetAdaptiveRefineLevel(HdRprApi* rprApi) const {
+    GfMatrix4d transform = m_transformSamples.count > 0 ? m_transformSamples.values[0] : GfMatrix4d(1.0);
+    double projectedSize = rprApi->GetProjectedSize(GfBBox3d(m_localBounds, transform));
+    if (projectedSize < 0.0) {
+        return m_refineLevel;
+    }
+
+    // Authored level when the mesh covers the whole viewport, one level less for each halving of its size
+    double level = m_refineLevel + std::log2(std::max(projectedSize, 1e-6));
+
+    // Switch the level only when it's off by more than the margin, so small camera moves do not rebuild the mesh back and forth
+    static constexpr double kHysteresis = 0.25;
+    int refineLevel = m_effectiveRefineLevel;
+    if (level >= refineLevel + 1 + kHysteresis || level < refineLevel - kHysteresis) {
+        refineLevel = static_cast<int>(std::floor(level));
+    }
+
+    return std::max(0, std::min(refineLevel, m_refineLevel));
+}
+
+size_t HdRprMesh::GetNumRefinedTriangles() const {
+    if (m_rprMeshes.empty()) {
+        return 0;
+    }
+
+    size_t numTriangles = m_numBaseTriangles;
+    if (m_effectiveRefineLevel > 0) {
+        // Each subdivision step splits a triangle into 4 triangles (Loop) or an n-gon into n quads (Catmull-Clark)
+        int level = m_effectiveRefineLevel;
+        numTriangles = m_isLoopSubdivisionScheme ?
+            m_numBaseTriangles << (2 * level) :
+            (2 * m_numBaseFaceVertices) << (2 * (level - 1));
+    }
+
+    if (!m_rprMeshInstances.empty()) {
+        numTriangles *= m_rprMeshInstances[0].size();
+    }
+
+    return numTriangles;
+}
+
+bool HdRprMesh::CanSubdivideOnCpu(HdRprApi* rprApi) const {
+    if (m_effectiveRefineLevel <= 0 || !rprApi->IsCpuSubdivisionEnabled() ||
+        m_topology.GetScheme() == PxOsdOpenSubdivTokens->none ||
+        m_pointSamples.empty() || !m_geomSubsets.empty()) {
+        return false;
+    }
+
+    // Only vertex data can be carried over to the refined surface
+    size_t numPoints = m_pointSamples.cdata()[0].size();
+    for (auto const& uvs : m_uvSamples) {
+        if (!m_uvIndices.empty() || uvs.size() != numPoints) {
+            return false;
+        }
+    }
+
+    if (m_authoredColors &&
+        m_colorInterpolation != HdInterpolationConstant &&
+        m_colorInterpolation != HdInterpolationVertex &&
+        m_colorInterpolation != HdInterpolationVarying) {
+        return false;
+    }
+
+    return true;
+}
+
+rpr::Shape* HdRprMesh::CreateRefinedMesh(HdSceneDelegate* sceneDelegate, HdRprApi* rprApi) {
+    SdfPath const& id = GetId();
+
+    if (!m_refinedTopologyValid) {
+        auto topology = m_topology.GetPxOsdMeshTopology().WithSubdivTags(sceneDelegate->GetSubdivTags(id));
+        m_refinedTopology = HdRprGetRefinedTopology(topology, m_effectiveRefineLevel, id);
+        m_refinedTopologyValid = true;
+    }
+    if (!m_refinedTopology) {
+        return nullptr;
+    }
+    auto const& refinedTopology = *m_refinedTopology;
+
+    // The refined topology is shared and reused, only the vertex data is evaluated on every update
+    VtArray<VtVec3fArray> pointSamples(m_pointSamples.size());
+    VtArray<VtVec3fArray> normalSamples(m_pointSamples.size());
+    VtArray<VtVec2fArray> uvSamples(m_uvSamples.size());
+    VtArray<VtVec3fArray> colorSamples(m_authoredColors ? m_colorSamples.size() : 0);
+
+    auto const& srcPointSamples = m_pointSamples;
+    auto const& srcUvSamples = m_uvSamples;
+    auto const& srcColorSamples = m_colorSamples;
+    const bool refineColors = m_colorInterpolation != HdInterpolationConstant;
+
+    auto pointSamplesData = pointSamples.data();
+    auto normalSamplesData = normalSamples.data();
+    auto uvSamplesData = uvSamples.data();
+    auto colorSamplesData = colorSamples.data();
+
+    std::atomic<bool> isValid(true);
+    WorkParallelForN(pointSamples.size(),
+        [&](size_t begin, size_t end) {
+            for (size_t i = begin; i < end; ++i) {
+                if (!HdRprRefinePoints(refinedTopology, srcPointSamples.cdata()[i], &pointSamplesData[i], &normalSamplesData[i])) {
+                    isValid = false;
+                }
+                if (i < uvSamples.size() &&
+                    !HdRprRefineVertexPrimvar(refinedTopology, srcUvSamples.cdata()[i], &uvSamplesData[i])) {
+                    isValid = false;
+                }
+                if (i < colorSamples.size()) {
+                    if (!refineColors) {
+                        colorSamplesData[i] = srcColorSamples.cdata()[i];
+                    } else if (!HdRprRefineVertexPrimvar(refinedTopology, srcColorSamples.cdata()[i], &colorSamplesData[i])) {
+                        isValid = false;
+                    }
+                }
+            }
+        }
+    );
+    if (!isValid) {
+        TF_RUNTIME_ERROR("[%s] Failed to refine mesh: vertex data does not match topology", id.GetText());
+        return nullptr;
+    }
+
+    // Varying colors are refined per vertex as well
+    auto colorInterpolation = refineColors ? HdInterpolationVertex : m_colorInterpolation;
+
+    // Refined topology is always right handed
+    auto rprMesh = rprApi->CreateMesh(pointSamples, refinedTopology.faceVertexIndices, normalSamples, VtIntArray(), uvSamples, VtIntArray(), refinedTopology.faceVertexCounts, HdTokens->rightHanded, &m_rprMeshTopologies[0], GetMeshDataState(colorSamples, colorInterpolation));
+    if (rprMesh) {
+        m_colorsSet = rprApi->SetMeshVertexColor(rprMesh, colorSamples, colorInterpolation);
+    }
+    return rprMesh;
+}
+
+HdRprApiMeshDataState HdRprMesh::GetMeshDataState(VtArray<VtVec3fArray> const& colorSamples, HdInterpolation colorInterpolation) const {
+    HdRprApiMeshDataState dataState;
+    // Meshes refined on the CPU are not subdivided by the core
+    dataState.refineLevel = m_isCpuSubdivided ? 0 : m_effectiveRefineLevel;
+    dataState.creaseWeight = m_subdivisionCreaseWeight;
+    dataState.boundaryInterpolation = m_vertexInterpolationRule;
+    dataState.colorSamples = colorSamples;
+    dataState.colorInterpolation = colorInterpolation;
+    return dataState;
+}
+
+void HdRprMesh::ReleaseCpuData() {
+    // Subset and material bindings are kept: they are required to update the existing RPR meshes
+    m_topology = HdMeshTopology();
+    m_faceVertexCounts = VtIntArray();
+    m_faceVertexIndices = VtIntArray();
+    m_pointSamples = VtArray<VtVec3fArray>();
+    m_normalSamples = VtArray<VtVec3fArray>();
+    m_normalIndices = VtIntArray();
+    m_colorSamples = VtArray<VtVec3fArray>();
+    m_uvSamples = VtArray<VtVec2fArray>();
+    m_uvIndices = VtIntArray();
+
+    m_adjacency = Hd_VertexAdjacency();
+    m_adjacencyValid = false;
+
+    m_geomSubsetTopologies.clear();
+    m_geomSubsetTopologiesValid = false;
+    m_rprMeshTopologies.clear();
+
+    m_cpuDataReleased = true;
+}
+
+size_t HdRprMesh::GetResidentBytes() const {
+    size_t numBytes = HdRprGetNumBytes(m_faceVertexCounts) + HdRprGetNumBytes(m_faceVertexIndices) +
+        HdRprGetNumBytes(m_pointSamples) + HdRprGetNumBytes(m_normalSamples) + HdRprGetNumBytes(m_normalIndices) +
+        HdRprGetNumBytes(m_colorSamples) + HdRprGetNumBytes(m_uvSamples) + HdRprGetNumBytes(m_uvIndices) +
+        HdRprGetNumBytes(m_adjacency.GetAdjacencyTable());
+
+    for (auto& topology : m_geomSubsetTopologies) {
+        numBytes += HdRprGetNumBytes(topology.indices) + HdRprGetNumBytes(topology.normalIndices) +
+            HdRprGetNumBytes(topology.uvIndices) + HdRprGetNumBytes(topology.vertexPerFace) +
+            (topology.pointSourceIndices.size() + topology.normalSourceIndices.size() + topology.uvSourceIndices.size()) * sizeof(int);
+    }
+
+    for (auto& topology : m_rprMeshTopologies) {
+        numBytes += HdRprGetNumBytes(topology.rprPointIndices) + HdRprGetNumBytes(topology.rprNormalIndices) +
+            HdRprGetNumBytes(topology.rprUvIndices) + HdRprGetNumBytes(topology.rprVpf);
+    }
+
+    return numBytes;
+}
+
 void HdRprMesh::Finalize(HdRenderParam* renderParam) {
     auto rprRenderParam = static_cast<HdRprRenderParam*>(renderParam);
     auto rprApi = rprRenderParam->AcquireRprApiForEdit();
@@ -845,6 +1400,16 @@ void HdRprMesh::Finalize(HdRenderParam* renderParam) {
     ReleaseInstances(rprApi);
     m_rprMeshes.clear();
 
+    SetResidentBytes(rprApi, HdPrimTypeTokens->mesh, 0);
+
+    rprApi->UpdateRefinedTriangleCount(-int64_t(m_numRefinedTriangles));
+    m_numRefinedTriangles = 0;
+
+    if (m_isSubscribedForCameraUpdates) {
+        rprRenderParam->UnsubscribeFromCameraUpdates(GetId());
+        m_isSubscribedForCameraUpdates = false;
+    }
+
     rprApi->Release(m_fallbackMaterial);
     m_fallbackMaterial = nullptr;
 
@@ -864,6 +1429,7 @@ void HdRprMesh::ReleaseInstances(HdRprApi* rprApi) {
         }
     }
     m_rprMeshInstances.clear();
+    m_instanceTransformHashes.clear();
 }
 
 PXR_NAMESPACE_CLOSE_SCOPE
@@ -15,12 +15,14 @@ limitations under the License.
 #define HDRPR_MESH_H
 
 #include "baseRprim.h"
+#include "subdivision.h"
 
 #include "pxr/imaging/hd/mesh.h"
 #include "pxr/imaging/hd/vertexAdjacency.h"
 #include "pxr/base/vt/array.h"
 #include "pxr/base/gf/vec2f.h"
 #include "pxr/base/gf/matrix4f.h"
+#include "pxr/base/gf/range3d.h"
 
 namespace rpr { class Shape; }
 
@@ -29,6 +31,7 @@ PXR_NAMESPACE_OPEN_SCOPE
 class HdRprApi;
 class HdRprInstancer;
 class RprUsdMaterial;
+struct HdRprApiMeshDataState;
 
 class HdRprMesh final : public HdRprBaseRprim<HdMesh> {
 public:
@@ -60,9 +63,27 @@ private:
 
     void ReleaseInstances(HdRprApi* rprApi);
 
+    int GetAdaptiveRefineLevel(HdRprApi* rprApi) const;
+    size_t GetNumRefinedTriangles() const;
+
+    bool CanSubdivideOnCpu(HdRprApi* rprApi) const;
+    rpr::Shape* CreateRefinedMesh(HdSceneDelegate* sceneDelegate, HdRprApi* rprApi);
+    HdRprApiMeshDataState GetMeshDataState(VtArray<VtVec3fArray> const& colorSamples, HdInterpolation colorInterpolation) const;
+
+    void ReleaseCpuData();
+    size_t GetResidentBytes() const;
+
+    bool DerivePointSamplesFromVelocities(
+        HdSceneDelegate* sceneDelegate,
+        HdRprApi* rprApi,
+        std::map<HdInterpolation, HdPrimvarDescriptorVector> const& primvarDescsPerInterpolation);
+
 private:
     std::vector<rpr::Shape*> m_rprMeshes;
     std::vector<std::vector<rpr::Shape*>> m_rprMeshInstances;
+    // Hashes of the last uploaded instance transforms, used to skip the instances that did not move
+    std::vector<uint64_t> m_instanceTransformHashes;
+    std::vector<HdRprApiMeshTopology> m_rprMeshTopologies;
     RprUsdMaterial* m_fallbackMaterial = nullptr;
 
     static constexpr int kDefaultNumTimeSamples = 2;
@@ -70,6 +91,23 @@ private:
 
     HdMeshTopology m_topology;
     HdGeomSubsets m_geomSubsets;
+
+    struct GeomSubsetTopology {
+        VtIntArray indices;
+        VtIntArray normalIndices;
+        VtIntArray uvIndices;
+        VtIntArray vertexPerFace;
+
+        // Mesh vertex data indices referenced by the subset
+        std::vector<int> pointSourceIndices;
+        std::vector<int> normalSourceIndices;
+        std::vector<int> uvSourceIndices;
+    };
+    std::vector<GeomSubsetTopology> m_geomSubsetTopologies;
+    bool m_geomSubsetTopologiesValid = false;
+    bool m_geomSubsetIndexedNormals = false;
+    bool m_geomSubsetIndexedUvs = false;
+
     VtArray<VtVec3fArray> m_pointSamples;
     VtIntArray m_faceVertexCounts;
     VtIntArray m_faceVertexIndices;
@@ -94,13 +132,32 @@ private:
     HdDisplayStyle m_displayStyle;
     int m_refineLevel = 0;
     float m_subdivisionCreaseWeight = 0.0;
+    TfToken m_vertexInterpolationRule;
+
+    // Refine level used for the RPR meshes, it differs from the authored one when adaptive subdivision is enabled
+    int m_effectiveRefineLevel = 0;
+    GfRange3d m_localBounds;
+    bool m_isSubscribedForCameraUpdates = false;
+
+    bool m_isLoopSubdivisionScheme = false;
+    size_t m_numBaseTriangles = 0;
+    size_t m_numBaseFaceVertices = 0;
+    size_t m_numRefinedTriangles = 0;
+
+    HdRprRefinedTopologySharedPtr m_refinedTopology;
+    bool m_refinedTopologyValid = false;
+    bool m_isCpuSubdivided = false;
 
     int m_id = -1;
     bool m_ignoreContour;
     std::string m_cryptomatteName;
     size_t m_numGeometrySamples = 1;
+    bool m_velocityBlur = false;
 
     HdRprInstancer* m_instancer = nullptr;
+
+    // Set when CPU-side copies of the geometry were dropped after the upload
+    bool m_cpuDataReleased = false;
 };
 
 PXR_NAMESPACE_CLOSE_SCOPE
@@ -0,0 +1,112 @@
+/************************************************************************
+Copyright 2020 Advanced Micro Devices, Inc
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+    http://www.apache.org/licenses/LICENSE-2.0
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+************************************************************************/
+
+#include "meshNormals.h"
+
+#include "pxr/imaging/hd/smoothNormals.h"
+#include "pxr/base/gf/limits.h"
+#include "pxr/base/work/loops.h"
+
+#include <cmath>
+
+PXR_NAMESPACE_OPEN_SCOPE
+
+VtVec3fArray HdRprComputeFlatNormals(
+    VtIntArray const& pointIndices,
+    VtIntArray const& faceIndices,
+    size_t numFaces,
+    VtVec3fArray const& points) {
+    VtVec3fArray normals(numFaces, GfVec3f(0.0f));
+    if (faceIndices.size() != pointIndices.size()) {
+        TF_CODING_ERROR("Face indices size (%zu) does not match point indices size (%zu)", faceIndices.size(), pointIndices.size());
+        return normals;
+    }
+
+    // Resolve all pointers before going parallel: workers must not trigger VtArray copy-on-write
+    GfVec3f* normalsData = normals.data();
+    int const* indicesData = pointIndices.cdata();
+    int const* facesData = faceIndices.cdata();
+    float const* pointsData = reinterpret_cast<float const*>(points.cdata());
+    const size_t numPoints = points.size();
+    const size_t numIndices = pointIndices.size();
+
+    // Every face-vertex that starts a new face computes the normal of that face,
+    // so the work is split over face-vertices and no face offsets are needed
+    WorkParallelForN(numIndices,
+        [=](size_t begin, size_t end) {
+            for (size_t i = begin; i < end; ++i) {
+                if (i != 0 && facesData[i] == facesData[i - 1]) {
+                    continue;
+                }
+
+                size_t face = facesData[i];
+                if (face >= numFaces || i + 2 >= numIndices) {
+                    continue;
+                }
+
+                size_t i0 = indicesData[i];
+                size_t i1 = indicesData[i + 1];
+                size_t i2 = indicesData[i + 2];
+                if (i0 >= numPoints || i1 >= numPoints || i2 >= numPoints) {
+                    continue;
+                }
+
+                float const* p0 = pointsData + 3 * i0;
+                float const* p1 = pointsData + 3 * i1;
+                float const* p2 = pointsData + 3 * i2;
+
+                float e0[3], e1[3];
+                for (int c = 0; c < 3; ++c) {
+                    e0[c] = p0[c] - p1[c];
+                    e1[c] = p2[c] - p1[c];
+                }
+
+                // n = normalize(e1 x e0)
+                float n[3] = {
+                    e1[1] * e0[2] - e1[2] * e0[1],
+                    e1[2] * e0[0] - e1[0] * e0[2],
+                    e1[0] * e0[1] - e1[1] * e0[0],
+                };
+                float length = std::sqrt(n[0] * n[0] + n[1] * n[1] + n[2] * n[2]);
+                float invLength = length > GF_MIN_VECTOR_LENGTH ? 1.0f / length : 1.0f / GF_MIN_VECTOR_LENGTH;
+
+                normalsData[face] = GfVec3f(n[0] * invLength, n[1] * invLength, n[2] * invLength);
+            }
+        }
+    );
+
+    return normals;
+}
+
+VtArray<VtVec3fArray> HdRprComputeSmoothNormals(
+    Hd_VertexAdjacency const* adjacency,
+    VtArray<VtVec3fArray> const& pointSamples) {
+    VtArray<VtVec3fArray> normalSamples(pointSamples.size());
+
+    // Hd_SmoothNormals is parallel over the vertices of a single sample,
+    // motion samples are independent of each other and processed concurrently as well
+    VtVec3fArray* normalSamplesData = normalSamples.data();
+    VtVec3fArray const* pointSamplesData = pointSamples.cdata();
+    WorkParallelForN(pointSamples.size(),
+        [=](size_t begin, size_t end) {
+            for (size_t iSample = begin; iSample < end; ++iSample) {
+                auto const& points = pointSamplesData[iSample];
+                normalSamplesData[iSample] = Hd_SmoothNormals::ComputeSmoothNormals(adjacency, points.size(), points.cdata());
+            }
+        }
+    );
+
+    return normalSamples;
+}
+
+PXR_NAMESPACE_CLOSE_SCOPE
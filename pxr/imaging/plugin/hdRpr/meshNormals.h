@@ -0,0 +1,39 @@
+/************************************************************************
+Copyright 2020 Advanced Micro Devices, Inc
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+    http://www.apache.org/licenses/LICENSE-2.0
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+************************************************************************/
+
+#ifndef HDRPR_MESH_NORMALS_H
+#define HDRPR_MESH_NORMALS_H
+
+#include "pxr/imaging/hd/vertexAdjacency.h"
+#include "pxr/base/vt/array.h"
+#include "pxr/base/gf/vec3f.h"
+
+PXR_NAMESPACE_OPEN_SCOPE
+
+// Computes one normal per face of a triangle/quad mesh.
+// faceIndices holds the index of the face each face-vertex belongs to, i.e. the normal indices of a flat shaded mesh.
+// Faces must be stored contiguously and have at least 3 vertices.
+VtVec3fArray HdRprComputeFlatNormals(
+    VtIntArray const& pointIndices,
+    VtIntArray const& faceIndices,
+    size_t numFaces,
+    VtVec3fArray const& points);
+
+// Computes smooth vertex normals for every motion sample of points
+VtArray<VtVec3fArray> HdRprComputeSmoothNormals(
+    Hd_VertexAdjacency const* adjacency,
+    VtArray<VtVec3fArray> const& pointSamples);
+
+PXR_NAMESPACE_CLOSE_SCOPE
+
+#endif // HDRPR_MESH_NORMALS_H
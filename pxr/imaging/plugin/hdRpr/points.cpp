@@ -19,10 +19,79 @@ limitations under the License.
 
 #include "pxr/imaging/rprUsd/debugCodes.h"
 #include "pxr/imaging/hd/extComputationUtils.h"
+#include "pxr/imaging/pxOsd/tokens.h"
 #include "pxr/usdImaging/usdImaging/implicitSurfaceMeshUtils.h"
+#include "pxr/base/work/loops.h"
+
+#include <algorithm>
+#include <cmath>
 
 PXR_NAMESPACE_OPEN_SCOPE
 
+TF_DEFINE_PRIVATE_TOKENS(_tokens,
+    (instances)
+    (spheres)
+    (discs)
+);
+
+namespace {
+
+// RPR shapes are kept reasonably small, huge particle systems are split into a few shapes
+constexpr size_t kMaxPointsPerShape = size_t(1) << 20;
+
+// Geometry of a single particle of unit radius, replicated for every point of the merged geometry
+struct ParticleShapeTemplate {
+    std::vector<GfVec3f> positions;
+    std::vector<GfVec3f> normals;
+    std::vector<int> faceVertexCounts;
+    std::vector<int> faceVertexIndices;
+};
+
+// Icosahedron, the cheapest closed shape that still reads as a sphere
+ParticleShapeTemplate const& GetSphereTemplate() {
+    static ParticleShapeTemplate const sphere = []() {
+        const float t = (1.0f + std::sqrt(5.0f)) * 0.5f;
+
+        ParticleShapeTemplate ret;
+        ret.positions = {
+            {-1, t, 0}, {1, t, 0}, {-1, -t, 0}, {1, -t, 0},
+            {0, -1, t}, {0, 1, t}, {0, -1, -t}, {0, 1, -t},
+            {t, 0, -1}, {t, 0, 1}, {-t, 0, -1}, {-t, 0, 1}
+        };
+        for (auto& position : ret.positions) {
+            position.Normalize();
+        }
+        ret.normals = ret.positions;
+        ret.faceVertexIndices = {
+            0, 11, 5,  0, 5, 1,  0, 1, 7,  0, 7, 10,  0, 10, 11,
+            1, 5, 9,  5, 11, 4,  11, 10, 2,  10, 7, 6,  7, 1, 8,
+            3, 9, 4,  3, 4, 2,  3, 2, 6,  3, 6, 8,  3, 8, 9,
+            4, 9, 5,  2, 4, 11,  6, 2, 10,  8, 6, 7,  9, 8, 1
+        };
+        ret.faceVertexCounts.assign(ret.faceVertexIndices.size() / 3, 3);
+        return ret;
+    }();
+    return sphere;
+}
+
+// Hexagon in the XY plane facing +Z, split into two quads
+ParticleShapeTemplate const& GetDiscTemplate() {
+    static ParticleShapeTemplate const disc = []() {
+        ParticleShapeTemplate ret;
+        for (int i = 0; i < 6; ++i) {
+            float angle = float(i) * float(M_PI) / 3.0f;
+            ret.positions.emplace_back(std::cos(angle), std::sin(angle), 0.0f);
+            ret.normals.emplace_back(0.0f, 0.0f, 1.0f);
+        }
+        ret.faceVertexCounts = {4, 4};
+        ret.faceVertexIndices = {0, 1, 2, 3, 0, 3, 4, 5};
+        return ret;
+    }();
+    return disc;
+}
+
+} // namespace anonymous
+
 HdRprPoints::HdRprPoints(SdfPath const& id HDRPR_INSTANCER_ID_ARG_DECL)
     : HdRprBaseRprim(id HDRPR_INSTANCER_ID_ARG)
     , m_visibilityMask(kVisibleAll)
@@ -43,6 +112,76 @@ void HdRprPoints::Sync(
     std::map<HdInterpolation, HdPrimvarDescriptorVector> primvarDescsPerInterpolation;
     SdfPath const& id = GetId();
 
+    bool dirtySubdivisionLevel = false;
+    bool dirtyVisibilityMask = false;
+    bool dirtyGeometryMode = false;
+    if (*dirtyBits & HdChangeTracker::DirtyPrimvar) {
+        HdRprGeometrySettings geomSettings;
+        geomSettings.visibilityMask = kVisibleAll;
+        HdRprFillPrimvarDescsPerInterpolation(sceneDelegate, id, &primvarDescsPerInterpolation);
+        HdRprParseGeometrySettings(sceneDelegate, id, primvarDescsPerInterpolation, &geomSettings);
+
+        if (m_subdivisionLevel != geomSettings.subdivisionLevel) {
+            m_subdivisionLevel = geomSettings.subdivisionLevel;
+            dirtySubdivisionLevel = true;
+        }
+
+        if (m_subdivisionCreaseWeight != geomSettings.subdivisionCreaseWeight) {
+            m_subdivisionCreaseWeight = geomSettings.subdivisionCreaseWeight;
+            dirtySubdivisionLevel = true;
+        }
+
+        if (m_visibilityMask != geomSettings.visibilityMask) {
+            m_visibilityMask = geomSettings.visibilityMask;
+            dirtyVisibilityMask = true;
+        }
+
+        TfToken geometryMode = geomSettings.pointsGeometry;
+        if (geometryMode != _tokens->spheres && geometryMode != _tokens->discs) {
+            geometryMode = _tokens->instances;
+        }
+        if (m_geometryMode != geometryMode) {
+            m_geometryMode = geometryMode;
+            dirtyGeometryMode = true;
+        }
+    }
+
+    if (dirtyGeometryMode) {
+        // Either representation is built from scratch
+        ReleaseInstances(rprApi);
+        ReleaseMergedGeometry(rprApi);
+    }
+
+    bool useInstances = m_geometryMode == _tokens->instances;
+    bool useCameraFacingDiscs = m_geometryMode == _tokens->discs;
+    if (m_isSubscribedForCameraUpdates != useCameraFacingDiscs) {
+        if (useCameraFacingDiscs) {
+            rprRenderParam->SubscribeForCameraUpdates(id);
+        } else {
+            rprRenderParam->UnsubscribeFromCameraUpdates(id);
+        }
+        m_isSubscribedForCameraUpdates = useCameraFacingDiscs;
+    }
+
+    // Deduplicated meshes share the subdivision level and vertex colors with the meshes of the same shape,
+    // so the prototype and merged shapes are created anew to change them
+    bool dirtyDeduplicatedMeshes = rprApi->IsMeshDeduplicationEnabled() &&
+        (useInstances ? (dirtySubdivisionLevel && m_prototypeMesh) :
+                        (!m_mergedShapes.empty() && HdChangeTracker::IsPrimvarDirty(*dirtyBits, id, HdTokens->displayColor)));
+    if (dirtyDeduplicatedMeshes && useInstances) {
+        ReleaseInstances(rprApi);
+    }
+
+    if (m_cpuDataReleased) {
+        // Instance transforms are computed from both points and widths, merged geometry has the transform applied to the shapes
+        static constexpr HdDirtyBits kInstanceTransformDirtyBits = HdChangeTracker::DirtyPoints | HdChangeTracker::DirtyWidths | HdChangeTracker::DirtyTransform;
+        static constexpr HdDirtyBits kMergedGeometryDirtyBits = HdChangeTracker::DirtyPoints | HdChangeTracker::DirtyWidths;
+        if ((*dirtyBits & (useInstances ? kInstanceTransformDirtyBits : kMergedGeometryDirtyBits)) || dirtyGeometryMode || dirtyDeduplicatedMeshes) {
+            *dirtyBits |= HdChangeTracker::DirtyPoints | HdChangeTracker::DirtyWidths;
+            m_cpuDataReleased = false;
+        }
+    }
+
     bool dirtyPoints = false;
     bool isPointsComputed = false;
     auto extComputationDescs = sceneDelegate->GetExtComputationPrimvarDescriptors(id, HdInterpolationVertex);
@@ -108,30 +247,6 @@ void HdRprPoints::Sync(
         m_transform = GfMatrix4f(sceneDelegate->GetTransform(id));
     }
 
-    bool dirtySubdivisionLevel = false;
-    bool dirtyVisibilityMask = false;
-    if (*dirtyBits & HdChangeTracker::DirtyPrimvar) {
-        HdRprGeometrySettings geomSettings;
-        geomSettings.visibilityMask = kVisibleAll;
-        HdRprFillPrimvarDescsPerInterpolation(sceneDelegate, id, &primvarDescsPerInterpolation);
-        HdRprParseGeometrySettings(sceneDelegate, id, primvarDescsPerInterpolation, &geomSettings);
-
-        if (m_subdivisionLevel != geomSettings.subdivisionLevel) {
-            m_subdivisionLevel = geomSettings.subdivisionLevel;
-            dirtySubdivisionLevel = true;
-        }
-
-        if (m_subdivisionCreaseWeight != geomSettings.subdivisionCreaseWeight) {
-            m_subdivisionCreaseWeight = geomSettings.subdivisionCreaseWeight;
-            dirtySubdivisionLevel = true;
-        }
-
-        if (m_visibilityMask != geomSettings.visibilityMask) {
-            m_visibilityMask = geomSettings.visibilityMask;
-            dirtyVisibilityMask = true;
-        }
-    }
-
     if (dirtyDisplayColors) {
         if (m_material) {
             rprApi->Release(m_material);
@@ -139,19 +254,26 @@ void HdRprPoints::Sync(
         }
 
         if (m_colorsInterpolation == HdInterpolationVertex) {
-            m_material = rprApi->CreatePointsMaterial(m_colors);
+            // Merged geometry carries colors in a primvar while instances are colored by their ids
+            if (useInstances) {
+                m_material = rprApi->CreatePointsMaterial(m_colors);
+                if (m_material && RprUsdIsLeakCheckEnabled()) {
+                    rprApi->SetName(m_material, id.GetText());
+                }
+            } else {
+                m_material = rprApi->CreatePrimvarColorLookupMaterial();
+            }
         } else if (!m_colors.empty()) {
+            // Pooled materials are shared with other rprims and named by the pool
             m_material = rprApi->CreateDiffuseMaterial(m_colors[0]);
         }
-
-        if (m_material && RprUsdIsLeakCheckEnabled()) {
-            rprApi->SetName(m_material, id.GetText());
-        }
     }
 
     bool dirtyPrototypeMesh = false;
     bool dirtyInstances = false;
-    if (m_instances.size() != m_points.size()) {
+    if (!useInstances) {
+        UpdateMergedGeometry(sceneDelegate, rprApi, *dirtyBits, dirtyPoints, dirtyDisplayColors, dirtyMaterialOverride, dirtyVisibilityMask);
+    } else if (!m_cpuDataReleased && m_instances.size() != m_points.size()) {
         if (m_points.empty()) {
             rprApi->Release(m_prototypeMesh);
             m_prototypeMesh = nullptr;
@@ -159,7 +281,11 @@ void HdRprPoints::Sync(
             auto& topology = UsdImagingGetUnitSphereMeshTopology();
             auto& points = UsdImagingGetUnitSphereMeshPoints();
 
-            m_prototypeMesh = rprApi->CreateMesh(points, topology.GetFaceVertexIndices(), points, topology.GetFaceVertexIndices(), VtVec2fArray(), VtIntArray(), topology.GetFaceVertexCounts(), topology.GetOrientation());
+            HdRprApiMeshDataState dataState;
+            dataState.refineLevel = m_subdivisionLevel;
+            dataState.creaseWeight = m_subdivisionCreaseWeight;
+
+            m_prototypeMesh = rprApi->CreateMesh(points, topology.GetFaceVertexIndices(), points, topology.GetFaceVertexIndices(), VtVec2fArray(), VtIntArray(), topology.GetFaceVertexCounts(), topology.GetOrientation(), dataState);
             rprApi->SetMeshVisibility(m_prototypeMesh, kInvisible);
             rprApi->SetMeshRefineLevel(m_prototypeMesh, m_subdivisionLevel, m_subdivisionCreaseWeight);
 
@@ -176,17 +302,14 @@ void HdRprPoints::Sync(
             }
             m_instances.resize(m_points.size());
         } else {
-            m_instances.reserve(m_points.size());
-            for (size_t i = m_instances.size(); i < m_points.size(); ++i) {
-                if (auto instance = rprApi->CreateMeshInstance(m_prototypeMesh)) {
-                    rprApi->SetMeshId(instance, i);
-                    m_instances.push_back(instance);
-
-                    if (RprUsdIsLeakCheckEnabled()) {
-                        rprApi->SetName(instance, id.GetText());
-                    }
+            auto newInstances = rprApi->CreateMeshInstances(m_prototypeMesh, m_points.size() - m_instances.size());
+            rprApi->SetMeshIds(newInstances.data(), newInstances.size(), uint32_t(m_instances.size()));
+            if (RprUsdIsLeakCheckEnabled()) {
+                for (auto instance : newInstances) {
+                    rprApi->SetName(instance, id.GetText());
                 }
             }
+            m_instances.insert(m_instances.end(), newInstances.begin(), newInstances.end());
 
             dirtyInstances = true;
         }
@@ -204,21 +327,26 @@ void HdRprPoints::Sync(
 
             std::function<float(size_t)> sampleWidth;
             if (m_widthsInterpolation == HdInterpolationVertex) {
-                sampleWidth = [this](size_t idx) { return m_widths[idx]; };
+                sampleWidth = [this](size_t idx) { return m_widths.cdata()[idx]; };
             } else if (m_widthsInterpolation == HdInterpolationConstant) {
-                sampleWidth = [this](size_t) { return m_widths[0]; };
+                sampleWidth = [this](size_t) { return m_widths.cdata()[0]; };
             } else {
                 sampleWidth = [](size_t) { return 1.0f; };
                 TF_WARN("[%s] Unsupported widths interpolation. Fallback value is 1.0f with a constant interpolation", id.GetText());
             }
 
-            for (size_t i = 0; i < m_instances.size(); ++i) {
-                auto& position = m_points[i];
-                auto width = sampleWidth(i);
-                auto transform = GfMatrix4f(1.0f).SetScale(GfVec3f(width)).SetTranslateOnly(position) * m_transform;
+            std::vector<GfMatrix4d> transforms(m_instances.size());
+            WorkParallelForN(m_instances.size(),
+                [&](size_t begin, size_t end) {
+                    for (size_t i = begin; i < end; ++i) {
+                        auto& position = m_points.cdata()[i];
+                        auto width = sampleWidth(i);
+                        transforms[i] = GfMatrix4d(GfMatrix4f(1.0f).SetScale(GfVec3f(width)).SetTranslateOnly(position) * m_transform);
+                    }
+                }
+            );
 
-                rprApi->SetTransform(m_instances[i], transform);
-            }
+            rprApi->SetTransforms(m_instances.data(), m_instances.size(), 1, nullptr, transforms.data());
         }
 
         if (!materialOverrideExists && (dirtyDisplayColors || dirtyInstances)) {
@@ -244,26 +372,261 @@ void HdRprPoints::Sync(
         if ((*dirtyBits & HdChangeTracker::DirtyVisibility) ||
             dirtyVisibilityMask || dirtyInstances) {
             auto visibilityMask = _sharedData.visible ? m_visibilityMask : kInvisible;
-            for (size_t i = 0; i < m_instances.size(); ++i) {
-                rprApi->SetMeshVisibility(m_instances[i], visibilityMask);
-            }
+            rprApi->SetMeshVisibility(m_instances.data(), m_instances.size(), visibilityMask);
         }
+
+        if (!m_cpuDataReleased && rprApi->IsCpuGeometryReleaseEnabled()) {
+            m_points = VtVec3fArray();
+            m_widths = VtFloatArray();
+            m_cpuDataReleased = true;
+        }
+    }
+
+    // Colors are baked into the material right away. Merged geometry needs them whenever it's rebuilt
+    if (useInstances && rprApi->IsCpuGeometryReleaseEnabled()) {
+        m_colors = VtVec3fArray();
     }
 
+    SetResidentBytes(rprApi, HdPrimTypeTokens->points, GetResidentBytes());
+
     *dirtyBits = HdChangeTracker::Clean;
 }
 
-void HdRprPoints::Finalize(HdRenderParam* renderParam) {
-    auto rprApi = static_cast<HdRprRenderParam*>(renderParam)->AcquireRprApiForEdit();
+void HdRprPoints::UpdateMergedGeometry(
+    HdSceneDelegate* sceneDelegate,
+    HdRprApi* rprApi,
+    HdDirtyBits dirtyBits,
+    bool dirtyPoints,
+    bool dirtyDisplayColors,
+    bool dirtyMaterialOverride,
+    bool dirtyVisibilityMask) {
+    SdfPath const& id = GetId();
+    bool useCameraFacingDiscs = m_geometryMode == _tokens->discs;
+
+    // Vertex colors of deduplicated shapes are shared with the shapes of the same geometry, so they're rebuilt as well
+    bool dirtyGeometry = m_mergedShapes.empty() || dirtyPoints ||
+        (dirtyBits & HdChangeTracker::DirtyWidths) ||
+        (dirtyDisplayColors && rprApi->IsMeshDeduplicationEnabled()) ||
+        (useCameraFacingDiscs && (dirtyBits & (HdRprDirtyCamera | HdChangeTracker::DirtyTransform)));
+    if (dirtyGeometry && m_cpuDataReleased) {
+        // Nothing has changed that requires the source data
+        dirtyGeometry = m_mergedShapes.empty();
+    }
 
-    rprApi->Release(m_prototypeMesh);
-    m_prototypeMesh = nullptr;
+    bool dirtyShapes = false;
+    if (dirtyGeometry) {
+        ReleaseMergedGeometry(rprApi);
+
+        if (!m_points.empty()) {
+            ParticleShapeTemplate const& shapeTemplate = useCameraFacingDiscs ? GetDiscTemplate() : GetSphereTemplate();
+
+            GfVec3f cameraPosition(0.0f);
+            GfVec3f cameraDirection(0.0f, 0.0f, -1.0f);
+            bool isOrthographic = true;
+            if (useCameraFacingDiscs && rprApi->GetCamera()) {
+                // Discs are generated in the object space of the points
+                GfMatrix4d worldToObject = GfMatrix4d(m_transform).GetInverse();
+                GfMatrix4d cameraToWorld = rprApi->GetCameraViewMatrix().GetInverse();
+                cameraPosition = GfVec3f(worldToObject.Transform(cameraToWorld.ExtractTranslation()));
+                cameraDirection = GfVec3f(worldToObject.TransformDir(-GfVec3d(cameraToWorld.GetRow3(2)))).GetNormalized();
+                isOrthographic = rprApi->GetCameraProjectionMatrix()[2][3] == 0.0;
+            }
+
+            auto getWidth = [this](size_t index) {
+                if (m_widthsInterpolation == HdInterpolationVertex && index < m_widths.size()) {
+                    return m_widths.cdata()[index];
+                } else if (m_widthsInterpolation == HdInterpolationConstant && !m_widths.empty()) {
+                    return m_widths.cdata()[0];
+                }
+                return 1.0f;
+            };
+
+            bool hasVertexColors = m_colorsInterpolation == HdInterpolationVertex && m_colors.size() == m_points.size();
+
+            for (size_t shapeBegin = 0; shapeBegin < m_points.size(); shapeBegin += kMaxPointsPerShape) {
+                size_t numPoints = std::min(kMaxPointsPerShape, m_points.size() - shapeBegin);
+                size_t numVertices = numPoints * shapeTemplate.positions.size();
+                size_t numFaces = numPoints * shapeTemplate.faceVertexCounts.size();
+                size_t numIndices = numPoints * shapeTemplate.faceVertexIndices.size();
+
+                VtVec3fArray points(numVertices);
+                VtVec3fArray normals(numVertices);
+                VtIntArray faceVertexCounts(numFaces);
+                VtIntArray faceVertexIndices(numIndices);
+                VtArray<VtVec3fArray> colorSamples;
+                if (hasVertexColors) {
+                    colorSamples.push_back(VtVec3fArray(numVertices));
+                }
+
+                GfVec3f const* positionsData = m_points.cdata() + shapeBegin;
+                GfVec3f const* colorsData = m_colors.cdata() + shapeBegin;
+                GfVec3f* pointsData = points.data();
+                GfVec3f* normalsData = normals.data();
+                int* faceVertexCountsData = faceVertexCounts.data();
+                int* faceVertexIndicesData = faceVertexIndices.data();
+                GfVec3f* vertexColorsData = hasVertexColors ? colorSamples[0].data() : nullptr;
+
+                WorkParallelForN(numPoints,
+                    [&](size_t begin, size_t end) {
+                        size_t numTemplateVertices = shapeTemplate.positions.size();
+                        size_t numTemplateFaces = shapeTemplate.faceVertexCounts.size();
+                        size_t numTemplateIndices = shapeTemplate.faceVertexIndices.size();
+
+                        for (size_t i = begin; i < end; ++i) {
+                            GfVec3f const& position = positionsData[i];
+                            float radius = 0.5f * getWidth(shapeBegin + i);
+
+                            // Discs are oriented in the basis that faces the camera, spheres use the identity basis
+                            GfVec3f axisX(1.0f, 0.0f, 0.0f), axisY(0.0f, 1.0f, 0.0f), axisZ(0.0f, 0.0f, 1.0f);
+                            if (useCameraFacingDiscs) {
+                                axisZ = isOrthographic ? -cameraDirection : (cameraPosition - position);
+                                if (axisZ.Normalize() < 1e-6f) {
+                                    axisZ = -cameraDirection;
+                                }
+                                axisX = std::abs(axisZ[0]) < 0.9f ? GfVec3f(1.0f, 0.0f, 0.0f) : GfVec3f(0.0f, 1.0f, 0.0f);
+                                axisX = GfCross(axisX, axisZ).GetNormalized();
+                                axisY = GfCross(axisZ, axisX);
+                            }
+
+                            size_t firstVertex = i * numTemplateVertices;
+                            for (size_t j = 0; j < numTemplateVertices; ++j) {
+                                GfVec3f const& templatePosition = shapeTemplate.positions[j];
+                                GfVec3f const& templateNormal = shapeTemplate.normals[j];
+                                pointsData[firstVertex + j] = position + radius * (templatePosition[0] * axisX + templatePosition[1] * axisY + templatePosition[2] * axisZ);
+                                normalsData[firstVertex + j] = templateNormal[0] * axisX + templateNormal[1] * axisY + templateNormal[2] * axisZ;
+                            }
+                            if (vertexColorsData) {
+                                std::fill_n(vertexColorsData + firstVertex, numTemplateVertices, colorsData[i]);
+                            }
+
+                            std::copy(shapeTemplate.faceVertexCounts.begin(), shapeTemplate.faceVertexCounts.end(), faceVertexCountsData + i * numTemplateFaces);
+                            int* indices = faceVertexIndicesData + i * numTemplateIndices;
+                            for (size_t j = 0; j < numTemplateIndices; ++j) {
+                                indices[j] = int(firstVertex) + shapeTemplate.faceVertexIndices[j];
+                            }
+                        }
+                    }
+                );
+
+                HdRprApiMeshDataState dataState;
+                dataState.colorSamples = colorSamples;
+                dataState.colorInterpolation = HdInterpolationVertex;
+
+                auto shape = rprApi->CreateMesh(points, faceVertexIndices, normals, faceVertexIndices, VtVec2fArray(), VtIntArray(), faceVertexCounts, PxOsdOpenSubdivTokens->rightHanded, dataState);
+                if (!shape) {
+                    continue;
+                }
+
+                if (hasVertexColors && !rprApi->SetMeshVertexColor(shape, colorSamples, HdInterpolationVertex)) {
+                    TF_WARN("[%s] Per-point colors of the merged points geometry are not supported by the active render quality", id.GetText());
+                }
+                if (RprUsdIsLeakCheckEnabled()) {
+                    rprApi->SetName(shape, id.GetText());
+                }
+                m_mergedShapes.push_back(shape);
+            }
+            rprApi->SetMeshIds(m_mergedShapes.data(), m_mergedShapes.size(), 0);
+        }
+
+        dirtyShapes = true;
+    } else if (dirtyDisplayColors && m_colorsInterpolation == HdInterpolationVertex) {
+        // Colors are expanded per vertex of the merged geometry
+        auto numTemplateVertices = (useCameraFacingDiscs ? GetDiscTemplate() : GetSphereTemplate()).positions.size();
+        for (size_t i = 0; i < m_mergedShapes.size(); ++i) {
+            size_t shapeBegin = i * kMaxPointsPerShape;
+            if (shapeBegin >= m_colors.size()) {
+                break;
+            }
+            size_t numPoints = std::min(kMaxPointsPerShape, m_colors.size() - shapeBegin);
+
+            VtArray<VtVec3fArray> colorSamples(1, VtVec3fArray(numPoints * numTemplateVertices));
+            GfVec3f const* colorsData = m_colors.cdata() + shapeBegin;
+            GfVec3f* vertexColorsData = colorSamples[0].data();
+            WorkParallelForN(numPoints,
+                [&](size_t begin, size_t end) {
+                    for (size_t j = begin; j < end; ++j) {
+                        std::fill_n(vertexColorsData + j * numTemplateVertices, numTemplateVertices, colorsData[j]);
+                    }
+                }
+            );
+            rprApi->SetMeshVertexColor(m_mergedShapes[i], colorSamples, HdInterpolationVertex);
+        }
+    }
+
+    if (m_mergedShapes.empty()) {
+        return;
+    }
 
+    if (dirtyShapes || (dirtyBits & HdChangeTracker::DirtyTransform)) {
+        for (auto shape : m_mergedShapes) {
+            rprApi->SetTransform(shape, m_transform);
+        }
+    }
+
+    bool materialOverrideExists = !m_materialId.IsEmpty();
+    if (!materialOverrideExists && (dirtyDisplayColors || dirtyShapes)) {
+        for (auto shape : m_mergedShapes) {
+            rprApi->SetMeshMaterial(shape, m_material, false);
+        }
+    } else if (materialOverrideExists && (dirtyMaterialOverride || dirtyShapes)) {
+        auto material = static_cast<const HdRprMaterial*>(
+            sceneDelegate->GetRenderIndex().GetSprim(HdPrimTypeTokens->material, m_materialId));
+
+        if (material && material->GetRprMaterialObject()) {
+            for (auto shape : m_mergedShapes) {
+                rprApi->SetMeshMaterial(shape, material->GetRprMaterialObject(), false);
+            }
+        }
+    }
+
+    if ((dirtyBits & HdChangeTracker::DirtyVisibility) || dirtyVisibilityMask || dirtyShapes) {
+        auto visibilityMask = _sharedData.visible ? m_visibilityMask : kInvisible;
+        rprApi->SetMeshVisibility(m_mergedShapes.data(), m_mergedShapes.size(), visibilityMask);
+    }
+
+    // Camera-facing discs are regenerated on camera changes, so their source data is kept
+    if (!m_cpuDataReleased && !useCameraFacingDiscs && rprApi->IsCpuGeometryReleaseEnabled()) {
+        m_points = VtVec3fArray();
+        m_widths = VtFloatArray();
+        m_cpuDataReleased = true;
+    }
+}
+
+void HdRprPoints::ReleaseMergedGeometry(HdRprApi* rprApi) {
+    for (auto shape : m_mergedShapes) {
+        rprApi->Release(shape);
+    }
+    m_mergedShapes.clear();
+}
+
+void HdRprPoints::ReleaseInstances(HdRprApi* rprApi) {
     for (auto instance : m_instances) {
         rprApi->Release(instance);
     }
     m_instances.clear();
 
+    rprApi->Release(m_prototypeMesh);
+    m_prototypeMesh = nullptr;
+}
+
+size_t HdRprPoints::GetResidentBytes() const {
+    return HdRprGetNumBytes(m_points) + HdRprGetNumBytes(m_colors) + HdRprGetNumBytes(m_widths);
+}
+
+void HdRprPoints::Finalize(HdRenderParam* renderParam) {
+    auto rprRenderParam = static_cast<HdRprRenderParam*>(renderParam);
+    auto rprApi = rprRenderParam->AcquireRprApiForEdit();
+
+    SetResidentBytes(rprApi, HdPrimTypeTokens->points, 0);
+
+    ReleaseInstances(rprApi);
+    ReleaseMergedGeometry(rprApi);
+
+    if (m_isSubscribedForCameraUpdates) {
+        rprRenderParam->UnsubscribeFromCameraUpdates(GetId());
+        m_isSubscribedForCameraUpdates = false;
+    }
+
     rprApi->Release(m_material);
     m_material = nullptr;
  
@@ -25,6 +25,7 @@ namespace rpr { class Shape; }
 
 PXR_NAMESPACE_OPEN_SCOPE
 
+class HdRprApi;
 class RprUsdMaterial;
 
 class HdRprPoints : public HdRprBaseRprim<HdPoints> {
@@ -48,9 +49,25 @@ protected:
     void _InitRepr(TfToken const& reprName,
                    HdDirtyBits* dirtyBits) override;
 
+private:
+    // Builds all points as a few shapes with a low-poly particle per point instead of an RPR instance per point
+    void UpdateMergedGeometry(
+        HdSceneDelegate* sceneDelegate,
+        HdRprApi* rprApi,
+        HdDirtyBits dirtyBits,
+        bool dirtyPoints,
+        bool dirtyDisplayColors,
+        bool dirtyMaterialOverride,
+        bool dirtyVisibilityMask);
+    void ReleaseMergedGeometry(HdRprApi* rprApi);
+    void ReleaseInstances(HdRprApi* rprApi);
+
+    size_t GetResidentBytes() const;
+
 private:
     rpr::Shape* m_prototypeMesh = nullptr;
     std::vector<rpr::Shape*> m_instances;
+    std::vector<rpr::Shape*> m_mergedShapes;
     RprUsdMaterial* m_material = nullptr;
 
     GfMatrix4f m_transform;
@@ -66,6 +83,13 @@ private:
     uint32_t m_visibilityMask;
     int m_subdivisionLevel;
     float m_subdivisionCreaseWeight;
+
+    // One of "instances", "spheres" or "discs"
+    TfToken m_geometryMode;
+    bool m_isSubscribedForCameraUpdates = false;
+
+    // Set when CPU-side copies of the points data were dropped after the upload
+    bool m_cpuDataReleased = false;
 };
 
 PXR_NAMESPACE_CLOSE_SCOPE
@@ -55,6 +55,10 @@ void HdRprParseGeometrySettings(
         } else if (primvarName == RprUsdTokens->primvarsRprObjectDeformSamples) {
             HdRprGetConstantPrimvar(desc.name, sceneDelegate, id, &geomSettings->numGeometrySamples);
             geomSettings->numGeometrySamples = std::max(1, geomSettings->numGeometrySamples);
+        } else if (primvarName == RprUsdTokens->primvarsRprObjectDeformVelocityBlur) {
+            HdRprGetConstantPrimvar(desc.name, sceneDelegate, id, &geomSettings->velocityBlur);
+        } else if (primvarName == RprUsdTokens->primvarsRprPointsGeometry) {
+            HdRprGetConstantPrimvar(desc.name, sceneDelegate, id, &geomSettings->pointsGeometry);
         } else if (primvarName == RprUsdTokens->primvarsRprObjectVisibilityCamera) {
             setVisibilityFlag(desc.name, kVisiblePrimary);
         } else if (primvarName == RprUsdTokens->primvarsRprObjectVisibilityShadow) {
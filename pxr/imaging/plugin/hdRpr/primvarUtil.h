@@ -47,6 +47,8 @@ struct HdRprGeometrySettings {
     bool ignoreContour = false;
     std::string cryptomatteName;
     int numGeometrySamples = 1;
+    bool velocityBlur = false;
+    TfToken pointsGeometry;
 };
 
 void HdRprParseGeometrySettings(
@@ -172,6 +174,20 @@ inline void HdRprGetPrimvarIndices(HdInterpolation interpolation, VtIntArray con
     }
 }
 
+template <typename T>
+size_t HdRprGetNumBytes(VtArray<T> const& array) {
+    return array.size() * sizeof(T);
+}
+
+template <typename T>
+size_t HdRprGetNumBytes(VtArray<VtArray<T>> const& samples) {
+    size_t numBytes = 0;
+    for (auto const& sample : samples) {
+        numBytes += HdRprGetNumBytes(sample);
+    }
+    return numBytes;
+}
+
 inline VtValue HdRpr_GetParam(HdSceneDelegate* sceneDelegate, SdfPath id, TfToken name) {
     // TODO: This is not Get() Because of the reasons listed here:
     // https://groups.google.com/g/usd-interest/c/k-N05Ac7SRk/m/RtK5HvglAQAJ
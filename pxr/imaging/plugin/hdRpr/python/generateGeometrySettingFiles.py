@@ -69,6 +69,23 @@ geometry_settings = [
                 'maxValue': 2 ** 16,
                 'help': 'The number of sub-frame samples to compute when rendering deformation motion blur over the shutter open time. The default is 1 (sample only at the start of the shutter time), giving no deformation blur by default. If you want rapidly deforming geometry to blur properly, you must increase this value to 2 or more. Note that this value is limited by the number of sub-samples available in the USD file being rendered.'
             },
+            {
+                'name': 'primvars:rpr:object:deform:velocityBlur',
+                'ui_name': 'Velocity Blur',
+                'defaultValue': False,
+                'help': 'Derive deformation motion samples from the velocities (and optional accelerations) primvar instead of sampling points over the shutter time. Requires Geometry Time Samples to be 2 or more.'
+            },
+            {
+                'name': 'primvars:rpr:points:geometry',
+                'ui_name': 'Points Geometry',
+                'defaultValue': 'instances',
+                'values': [
+                    SettingValue('instances', 'Instances'),
+                    SettingValue('spheres', 'Merged Spheres'),
+                    SettingValue('discs', 'Merged Camera-Facing Discs')
+                ],
+                'help': 'How points are represented. Merged geometry syncs much faster and takes less memory for large particle systems.'
+            },
             {
                 'folder': 'Visibility Settings',
                 'settings': visibility_flag_settings
@@ -659,6 +659,92 @@ render_setting_categories = [
                 'houdini': {
                     'hidewhen': hidewhen_not_northstar
                 }
+            },
+            {
+                'name': 'motionBlur:framesPerSecond',
+                'ui_name': 'Frames Per Second',
+                'defaultValue': 24.0,
+                'minValue': 1.0,
+                'maxValue': 1000.0,
+                'help': 'Used to convert camera shutter interval from frames to seconds when deformation motion samples are derived from velocities and accelerations.',
+                'houdini': {
+                    'hidewhen': hidewhen_not_northstar
+                }
+            }
+        ]
+    },
+    {
+        'name': 'Geometry',
+        'settings': [
+            {
+                'name': 'geometry:deduplicateMeshes',
+                'ui_name': 'Deduplicate Identical Meshes',
+                'defaultValue': False,
+                'help': 'Meshes with identical topology, points, normals, UVs, vertex colors and subdivision settings share a single RPR mesh. Applies to meshes created after the change.'
+            },
+            {
+                'name': 'geometry:releaseCpuData',
+                'ui_name': 'Release CPU Geometry Data',
+                'defaultValue': False,
+                'help': 'Drop CPU-side copies of mesh, curves and points data once it is uploaded to RPR. Data is fetched from the scene again only when the geometry has to be rebuilt. Reduces memory usage of batch renders.'
+            },
+            {
+                'name': 'geometry:cpuSubdivision',
+                'ui_name': 'CPU Subdivision',
+                'defaultValue': False,
+                'help': 'Refine subdivision surfaces with OpenSubdiv on the CPU during sync instead of in the render core. Refined topology is shared between meshes and reused while only the points are animated. Meshes with GeomSubsets, face-varying UVs or uniform colors are subdivided by the render core. Crease weight setting is ignored.'
+            },
+            {
+                'name': 'geometry:adaptiveSubdivision',
+                'ui_name': 'Adaptive Subdivision',
+                'defaultValue': False,
+                'help': 'Choose subdivision level of each mesh from its size on the screen. Meshes that cover the whole viewport get the authored level, each halving of the size lowers the level by one. Instanced meshes always use the authored level.'
+            },
+            {
+                'name': 'geometry:hairLod',
+                'ui_name': 'Hair Level of Detail',
+                'defaultValue': False,
+                'help': 'Render a deterministic subset of the strands of dense curves, chosen from their size on the screen. Surviving strands are widened to keep the coverage. Instanced curves are always rendered in full.'
+            },
+            {
+                'name': 'geometry:hairLodStrandsPerPixel',
+                'ui_name': 'Hair Strands per Pixel',
+                'defaultValue': 4.0,
+                'minValue': 0.01,
+                'maxValue': 1000.0,
+                'help': 'Number of strands kept per pixel covered by the curves.',
+                'houdini': {
+                    'hidewhen': 'geometry:hairLod == 0'
+                }
+            }
+        ]
+    },
+    {
+        'name': 'Volume',
+        'settings': [
+            {
+                'name': 'volume:gridCacheBudgetMb',
+                'ui_name': 'VDB Grid Cache Budget (MB)',
+                'defaultValue': 4096,
+                'minValue': 0,
+                'maxValue': 65536,
+                'help': 'Memory budget of the OpenVDB grids kept in memory after volume conversion. Grids are shared between all volumes that reference the same file and are read again only when the file is modified. Least recently used grids are dropped when the budget is exceeded.'
+            },
+            {
+                'name': 'volume:voxelBudget',
+                'ui_name': 'Voxel Budget (Millions)',
+                'defaultValue': 0,
+                'minValue': 0,
+                'maxValue': 4096,
+                'help': 'Maximum number of active voxels of a volume grid in millions, 0 disables the limit. Grids over the budget are resampled to a coarser voxel size, resampled grids are kept in the grid cache. Batch renders always use full resolution grids. Applies to volumes synced after the change.'
+            },
+            {
+                'name': 'volume:prefetchFrames',
+                'ui_name': 'VDB Sequence Prefetch Frames',
+                'defaultValue': 0,
+                'minValue': 0,
+                'maxValue': 16,
+                'help': 'Number of upcoming frames of .vdb file sequences read into the grid cache in the background during playback. Prefetching starts once the file path of a field changes to another frame of the same sequence, the next frame files are found by stepping the frame number in the file name. Prefetched grids count towards the grid cache budget and are kept until they are used or the playback moves past them, prefetching pauses while they fill the budget.'
             }
         ]
     },
@@ -38,6 +38,7 @@ limitations under the License.
 #ifdef USE_VOLUME
 #include "volume.h"
 #include "field.h"
+#include "vdbGridCache.h"
 #endif
 
 #include <ctime>
@@ -379,6 +380,32 @@ VtDictionary HdRprDelegate::GetRenderStats() const {
     stats["cacheCreationTime"] = rprStats.cacheCreationTime;
     stats["syncTime"] = rprStats.syncTime;
 
+    stats["numDeduplicatedMeshes"] = rprStats.numDeduplicatedMeshes;
+    stats["deduplicatedMeshBytes"] = rprStats.deduplicatedMeshBytes;
+    stats["numSharedLightMeshes"] = rprStats.numSharedLightMeshes;
+    stats["peakStagingMemoryBytes"] = rprStats.peakStagingMemoryBytes;
+    stats["residentMeshBytes"] = rprStats.residentMeshBytes;
+    stats["residentCurvesBytes"] = rprStats.residentCurvesBytes;
+    stats["residentPointsBytes"] = rprStats.residentPointsBytes;
+    stats["numRefinedTriangles"] = rprStats.numRefinedTriangles;
+    stats["numUpdatedInstanceTransforms"] = rprStats.numUpdatedInstanceTransforms;
+    stats["numSkippedInstanceTransforms"] = rprStats.numSkippedInstanceTransforms;
+    stats["numRetainedHairStrands"] = rprStats.numRetainedHairStrands;
+    stats["hairLodSavedBytes"] = rprStats.hairLodSavedBytes;
+    stats["numPooledMaterials"] = rprStats.numPooledMaterials;
+    stats["numMaterialPoolHits"] = rprStats.numMaterialPoolHits;
+    stats["numMaterialPoolMisses"] = rprStats.numMaterialPoolMisses;
+    size_t numMaterialPoolRequests = rprStats.numMaterialPoolHits + rprStats.numMaterialPoolMisses;
+    stats["materialPoolHitRate"] = numMaterialPoolRequests ? double(rprStats.numMaterialPoolHits) / numMaterialPoolRequests : 0.0;
+
+#ifdef USE_VOLUME
+    auto vdbGridCacheStats = HdRprGetVdbGridCacheStats();
+    stats["numCachedVdbGrids"] = vdbGridCacheStats.numGrids;
+    stats["vdbGridCacheBytes"] = vdbGridCacheStats.numBytes;
+    stats["numVdbGridCacheHits"] = vdbGridCacheStats.numHits;
+    stats["numVdbGridCacheMisses"] = vdbGridCacheStats.numMisses;
+#endif
+
     return stats;
 }
 
@@ -14,10 +14,26 @@ limitations under the License.
 #include "renderParam.h"
 #include "volume.h"
 
+#ifdef USE_VOLUME
+#include "vdbGridCache.h"
+#endif // USE_VOLUME
+
 #include "pxr/imaging/hd/sceneDelegate.h"
 
 PXR_NAMESPACE_OPEN_SCOPE
 
+HdRprRenderParam::HdRprRenderParam(HdRprApi* rprApi, HdRprRenderThread* renderThread)
+    : m_rprApi(rprApi)
+    , m_renderThread(renderThread)
+#ifdef USE_VOLUME
+    , m_vdbGridPrefetcher(new HdRprVdbGridPrefetcher)
+#endif // USE_VOLUME
+{
+
+}
+
+HdRprRenderParam::~HdRprRenderParam() = default;
+
 HdRprVolumeFieldSubscription HdRprRenderParam::SubscribeVolumeForFieldUpdates(
     HdRprVolume* volume, SdfPath const& fieldId) {
     auto sub = HdRprVolumeFieldSubscription(volume, [](HdRprVolume* volume) {});
@@ -82,6 +98,24 @@ void HdRprRenderParam::MaterialDidChange(HdSceneDelegate* sceneDelegate, SdfPath
     }
 }
 
+void HdRprRenderParam::SubscribeForCameraUpdates(SdfPath const& rPrimId) {
+    std::lock_guard<std::mutex> lock(m_cameraSubscriptionsMutex);
+    m_cameraSubscriptions.insert(rPrimId);
+}
+
+void HdRprRenderParam::UnsubscribeFromCameraUpdates(SdfPath const& rPrimId) {
+    std::lock_guard<std::mutex> lock(m_cameraSubscriptionsMutex);
+    m_cameraSubscriptions.erase(rPrimId);
+}
+
+void HdRprRenderParam::CameraDidChange(HdSceneDelegate* sceneDelegate) {
+    std::lock_guard<std::mutex> lock(m_cameraSubscriptionsMutex);
+    HdChangeTracker& changeTracker = sceneDelegate->GetRenderIndex().GetChangeTracker();
+    for (auto& rPrimId : m_cameraSubscriptions) {
+        changeTracker.MarkRprimDirty(rPrimId, HdRprDirtyCamera);
+    }
+}
+
 size_t RprApiSafeWrapper::m_ptrCounter = 0;
 std::mutex RprApiSafeWrapper::m_threadControlMutex;
 
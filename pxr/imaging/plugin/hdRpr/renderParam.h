@@ -17,11 +17,18 @@ limitations under the License.
 #include "renderThread.h"
 
 #include "pxr/imaging/hd/renderDelegate.h"
+#include "pxr/imaging/hd/changeTracker.h"
 
 PXR_NAMESPACE_OPEN_SCOPE
 
+// Set on rprims subscribed for camera updates when any camera is changed
+constexpr HdDirtyBits HdRprDirtyCamera = HdChangeTracker::CustomBitsBegin;
+
 class HdRprApi;
 class HdRprVolume;
+#ifdef USE_VOLUME
+class HdRprVdbGridPrefetcher;
+#endif // USE_VOLUME
 
 using HdRprVolumeFieldSubscription = std::shared_ptr<HdRprVolume>;
 using HdRprVolumeFieldSubscriptionHandle = std::weak_ptr<HdRprVolume>;
@@ -56,10 +63,8 @@ private:
 
 class HdRprRenderParam final : public HdRenderParam {
 public:
-    HdRprRenderParam(HdRprApi* rprApi, HdRprRenderThread* renderThread)
-        : m_rprApi(rprApi)
-        , m_renderThread(renderThread) {}
-    ~HdRprRenderParam() override = default;
+    HdRprRenderParam(HdRprApi* rprApi, HdRprRenderThread* renderThread);
+    ~HdRprRenderParam() override;
 
     HdRprApi const* GetRprApi() const { return m_rprApi; }
     RprApiSafeWrapper AcquireRprApiForEdit() {
@@ -68,6 +73,11 @@ public:
 
     HdRprRenderThread* GetRenderThread() { return m_renderThread; }
 
+#ifdef USE_VOLUME
+    // Reads the upcoming frames of VDB sequences in the background, stopped with the render delegate
+    HdRprVdbGridPrefetcher* GetVdbGridPrefetcher() { return m_vdbGridPrefetcher.get(); }
+#endif // USE_VOLUME
+
     // Hydra does not mark HdVolume as changed if HdField used by it is changed
     // We implement this volume-to-field dependency by ourself until it's implemented in Hydra
     // More info: https://groups.google.com/forum/#!topic/usd-interest/pabUE0B_5X4
@@ -81,6 +91,12 @@ public:
     void UnsubscribeFromMaterialUpdates(SdfPath const& materialId, SdfPath const& rPrimId);
     void MaterialDidChange(HdSceneDelegate* sceneDelegate, SdfPath const materialId);
 
+    // Hydra does not resync rprims when the camera is changed.
+    // Rprims which geometry depends on the camera (e.g. adaptive subdivision) subscribe to be marked with HdRprDirtyCamera.
+    void SubscribeForCameraUpdates(SdfPath const& rPrimId);
+    void UnsubscribeFromCameraUpdates(SdfPath const& rPrimId);
+    void CameraDidChange(HdSceneDelegate* sceneDelegate);
+
     void RestartRender() { m_restartRender.store(true); }
     bool IsRenderShouldBeRestarted() { return m_restartRender.exchange(false); }
 
@@ -94,7 +110,14 @@ private:
     std::mutex m_materialSubscriptionsMutex;
     std::map<SdfPath, std::set<SdfPath>> m_materialSubscriptions;
 
+    std::mutex m_cameraSubscriptionsMutex;
+    std::set<SdfPath> m_cameraSubscriptions;
+
     std::atomic<bool> m_restartRender;
+
+#ifdef USE_VOLUME
+    std::unique_ptr<HdRprVdbGridPrefetcher> m_vdbGridPrefetcher;
+#endif // USE_VOLUME
 };
 
 PXR_NAMESPACE_CLOSE_SCOPE
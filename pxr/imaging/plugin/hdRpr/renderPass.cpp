@@ -74,6 +74,13 @@ void HdRprRenderPass::_Execute(HdRenderPassStateSharedPtr const& renderPassState
 
     auto rprApiConst = m_renderParam->GetRprApi();
 
+    // Rprims read geometry settings such as adaptive subdivision or hair LOD on sync, so all of them are resynced on the next frame
+    auto geometrySettingsVersion = rprApiConst->GetGeometrySettingsVersion();
+    if (m_geometrySettingsVersion != geometrySettingsVersion) {
+        m_geometrySettingsVersion = geometrySettingsVersion;
+        GetRenderIndex()->GetChangeTracker().MarkAllRprimsDirty(HdChangeTracker::DirtyDisplayStyle);
+    }
+
     GfVec2i newViewportSize = GetViewportSize(renderPassState);
     auto oldViewportSize = rprApiConst->GetViewportSize();
     if (oldViewportSize != newViewportSize) {
@@ -37,6 +37,7 @@ public:
 
 private:
     HdRprRenderParam* m_renderParam;
+    uint32_t m_geometrySettingsVersion = 0;
 };
 
 PXR_NAMESPACE_CLOSE_SCOPE
@@ -17,6 +17,7 @@ using json = nlohmann::json;
 #include "rprApi.h"
 #include "rprApiAov.h"
 #include "aovDescriptor.h"
+#include "meshNormals.h"
 
 #include "rifcpp/rifFilter.h"
 #include "rifcpp/rifImage.h"
@@ -43,9 +44,11 @@ using json = nlohmann::json;
 #include "pxr/base/gf/math.h"
 #include "pxr/base/gf/vec2f.h"
 #include "pxr/base/gf/rotation.h"
+#include "pxr/base/gf/range2d.h"
 #include "pxr/base/arch/fileSystem.h"
 #include "pxr/base/plug/plugin.h"
 #include "pxr/base/plug/thisPlugin.h"
+#include "pxr/imaging/hd/tokens.h"
 #include "pxr/imaging/pxOsd/tokens.h"
 #include "pxr/usd/usdRender/tokens.h"
 #include "pxr/usd/usdGeom/tokens.h"
@@ -81,7 +84,9 @@ using json = nlohmann::json;
 #include <fstream>
 #include <chrono>
 #include <vector>
+#include <unordered_map>
 #include <mutex>
+#include <tuple>
 
 #include <ghc/filesystem.hpp>
 namespace fs = ghc::filesystem;
@@ -161,42 +166,377 @@ GfVec4f ColorizeId(uint32_t id) {
     };
 }
 
-template <typename T>
-std::unique_ptr<T[]> MergeSamples(VtArray<VtArray<T>>* samples, size_t requiredNumSamples, rpr_float const** rprData, size_t* rprDataSize) {
-    if (samples->empty()) {
-        *rprData = nullptr;
-        *rprDataSize = 0;
-        return nullptr;
-    }
+// Reusable memory for packing mesh motion samples into the contiguous layout RPR expects.
+// Blocks are recycled between meshes, so only the largest simultaneous demand is allocated during a sync
+class StagingMemoryPool {
+public:
+    class Block {
+    public:
+        Block() = default;
+        Block(StagingMemoryPool* pool, std::unique_ptr<uint8_t[]> data, size_t size)
+            : m_pool(pool), m_data(std::move(data)), m_size(size) {}
+        Block(Block&& other) = default;
+        Block& operator=(Block&& other) = default;
+        ~Block() {
+            if (m_pool && m_data) {
+                m_pool->Recycle(std::move(m_data), m_size);
+            }
+        }
+
+        uint8_t* GetData() const { return m_data.get(); }
 
-    if (samples->size() != requiredNumSamples) {
-        samples->resize(requiredNumSamples, [backElem=samples->back()](auto begin, auto end) {
-            for (auto it = begin; it != end; ++it) {
-                *it = backElem;
+    private:
+        StagingMemoryPool* m_pool = nullptr;
+        std::unique_ptr<uint8_t[]> m_data;
+        size_t m_size = 0;
+    };
+
+    Block Acquire(size_t size) {
+        std::lock_guard<std::mutex> lock(m_mutex);
+
+        // Take the smallest free block that fits
+        auto bestIt = m_freeBlocks.end();
+        for (auto it = m_freeBlocks.begin(); it != m_freeBlocks.end(); ++it) {
+            if (it->second >= size && (bestIt == m_freeBlocks.end() || it->second < bestIt->second)) {
+                bestIt = it;
             }
-        });
+        }
+        if (bestIt != m_freeBlocks.end()) {
+            Block block(this, std::move(bestIt->first), bestIt->second);
+            m_freeBlocks.erase(bestIt);
+            return block;
+        }
+
+        // None fits: replace the largest free block with a bigger one instead of keeping both
+        if (!m_freeBlocks.empty()) {
+            auto largestIt = std::max_element(m_freeBlocks.begin(), m_freeBlocks.end(),
+                [](FreeBlock const& lhs, FreeBlock const& rhs) { return lhs.second < rhs.second; });
+            m_allocatedSize -= largestIt->second;
+            m_freeBlocks.erase(largestIt);
+        }
+
+        m_allocatedSize += size;
+        m_peakSize = std::max(m_peakSize, m_allocatedSize);
+        return Block(this, std::unique_ptr<uint8_t[]>(new uint8_t[size]), size);
     }
 
-    const size_t numSampleValues = samples->cdata()[0].size();
-    auto mergedSamples = std::make_unique<T[]>(requiredNumSamples * numSampleValues);
+    // Frees the blocks that are not in use
+    void Trim() {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        for (auto& block : m_freeBlocks) {
+            m_allocatedSize -= block.second;
+        }
+        m_freeBlocks.clear();
+    }
 
-    for (size_t i = 0; i < requiredNumSamples; ++i) {
-        size_t offset = i * numSampleValues;
-        VtArray<T> const& values = samples->cdata()[i];
-        std::copy(values.cbegin(), values.cend(), mergedSamples.get() + offset);
+    size_t GetPeakSize() const {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_peakSize;
+    }
 
+private:
+    void Recycle(std::unique_ptr<uint8_t[]> data, size_t size) {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_freeBlocks.emplace_back(std::move(data), size);
+    }
+
+private:
+    using FreeBlock = std::pair<std::unique_ptr<uint8_t[]>, size_t>;
+
+    mutable std::mutex m_mutex;
+    std::vector<FreeBlock> m_freeBlocks;
+    size_t m_allocatedSize = 0;
+    size_t m_peakSize = 0;
+};
+
+template <typename T>
+size_t GetMergedSamplesSize(VtArray<VtArray<T>> const& samples, size_t requiredNumSamples) {
+    return samples.empty() ? 0 : requiredNumSamples * samples.cdata()[0].size() * sizeof(T);
+}
+
+template <typename T>
+void MergeSamples(VtArray<VtArray<T>> const& samples, size_t requiredNumSamples, uint8_t* dst, rpr_float const** rprData, size_t* rprDataSize) {
+    *rprData = nullptr;
+    *rprDataSize = 0;
+
+    if (samples.empty()) {
+        return;
+    }
+
+    const size_t numSampleValues = samples.cdata()[0].size();
+    auto mergedSamples = reinterpret_cast<T*>(dst);
+
+    for (size_t i = 0; i < requiredNumSamples; ++i) {
+        // Missing samples are padded with the last one
+        VtArray<T> const& values = samples.cdata()[std::min(i, samples.size() - 1)];
         if (values.size() != numSampleValues) {
-            TF_RUNTIME_ERROR("Non-uniform size between samples: %zu vs %zu", samples->size(), numSampleValues);
-            *rprData = nullptr;
-            *rprDataSize = 0;
-            return nullptr;
+            TF_RUNTIME_ERROR("Non-uniform size between samples: %zu vs %zu", values.size(), numSampleValues);
+            return;
         }
+
+        std::copy(values.cbegin(), values.cend(), mergedSamples + i * numSampleValues);
     }
 
-    *rprData = (rpr_float const*)mergedSamples.get();
+    *rprData = (rpr_float const*)mergedSamples;
     *rprDataSize = requiredNumSamples * numSampleValues;
+}
+
+using MeshContentHash = std::pair<uint64_t, uint64_t>;
+
+class MeshContentHasher {
+public:
+    template <typename T>
+    void Append(VtArray<T> const& values) {
+        Append(values.cdata(), values.size() * sizeof(T));
+    }
+
+    template <typename T>
+    void Append(VtArray<VtArray<T>> const& samples) {
+        Append(samples.size());
+        for (auto& values : samples) {
+            Append(values);
+        }
+    }
+
+    void Append(size_t value) {
+        Combine(value);
+    }
+
+    void Append(void const* data, size_t size) {
+        Combine(size);
+        m_numBytes += size;
+
+        // MurmurHash3 takes the length as int, so hash huge buffers chunk by chunk
+        static constexpr size_t kMaxChunkSize = size_t(1) << 30;
+        auto bytes = static_cast<uint8_t const*>(data);
+        while (size) {
+            size_t chunkSize = std::min(size, kMaxChunkSize);
+            uint64_t chunkHash[2];
+            MurmurHash3_x64_128(bytes, static_cast<int>(chunkSize), 0, chunkHash);
+            Combine(chunkHash[0]);
+            Combine(chunkHash[1]);
+            bytes += chunkSize;
+            size -= chunkSize;
+        }
+    }
+
+    MeshContentHash GetHash() const { return {m_hash[0], m_hash[1]}; }
+    size_t GetNumBytes() const { return m_numBytes; }
+
+private:
+    void Combine(uint64_t value) {
+        m_hash[0] ^= value + 0x9e3779b97f4a7c15ull + (m_hash[0] << 6) + (m_hash[0] >> 2);
+        m_hash[1] ^= (value * 0xff51afd7ed558ccdull) + 0x9e3779b97f4a7c15ull + (m_hash[1] << 6) + (m_hash[1] >> 2);
+    }
 
-    return mergedSamples;
+private:
+    uint64_t m_hash[2] = {0, 0};
+    size_t m_numBytes = 0;
+};
+
+// HdRprApiMeshDataState in the form it's applied to RPR meshes
+struct MeshDataState {
+    int refineLevel = 0;
+    float creaseWeight = 0.0f;
+    rpr_subdiv_boundary_interfop_type boundaryInterfopType = RPR_SUBDIV_BOUNDARY_INTERFOP_TYPE_EDGE_ONLY;
+    MeshContentHash colorsHash = {0, 0};
+};
+
+// Data a prototype was created from, compared on hash matches so that a hash collision never shares wrong geometry
+struct MeshPrototypeContent {
+    VtArray<VtVec3fArray> pointSamples;
+    VtIntArray pointIndices;
+    VtArray<VtVec3fArray> normalSamples;
+    VtIntArray normalIndices;
+    VtArray<VtVec2fArray> uvSamples;
+    VtIntArray uvIndices;
+    VtIntArray vpf;
+    TfToken polygonWinding;
+    int refineLevel;
+    float creaseWeight;
+    TfToken boundaryInterpolation;
+    VtArray<VtVec3fArray> colorSamples;
+    HdInterpolation colorInterpolation;
+    bool isLightMesh;
+
+    bool operator==(MeshPrototypeContent const& other) const {
+        // Cheap members first, VtArray compares the sizes before the values
+        return isLightMesh == other.isLightMesh &&
+            refineLevel == other.refineLevel &&
+            creaseWeight == other.creaseWeight &&
+            boundaryInterpolation == other.boundaryInterpolation &&
+            colorInterpolation == other.colorInterpolation &&
+            polygonWinding == other.polygonWinding &&
+            vpf == other.vpf &&
+            pointIndices == other.pointIndices &&
+            normalIndices == other.normalIndices &&
+            uvIndices == other.uvIndices &&
+            pointSamples == other.pointSamples &&
+            normalSamples == other.normalSamples &&
+            uvSamples == other.uvSamples &&
+            colorSamples == other.colorSamples;
+    }
+};
+
+struct MeshPrototype {
+    rpr::Shape* mesh;
+    size_t numUsers;
+    size_t numBytes;
+    MeshDataState dataState;
+    // Light meshes are shared regardless of the mesh deduplication setting
+    bool isLightMesh;
+    MeshPrototypeContent content;
+};
+
+rpr_subdiv_boundary_interfop_type GetBoundaryInterfopType(TfToken const& boundaryInterpolation) {
+    return boundaryInterpolation == PxOsdOpenSubdivTokens->edgeAndCorner ?
+        RPR_SUBDIV_BOUNDARY_INTERFOP_TYPE_EDGE_AND_CORNER :
+        RPR_SUBDIV_BOUNDARY_INTERFOP_TYPE_EDGE_ONLY;
+}
+
+MeshContentHash GetVertexColorHash(VtArray<VtVec3fArray> const& colorSamples, HdInterpolation colorInterpolation) {
+    if (colorSamples.empty()) {
+        return {0, 0};
+    }
+
+    MeshContentHasher hasher;
+    hasher.Append(colorSamples);
+    hasher.Append(size_t(colorInterpolation));
+    return hasher.GetHash();
+}
+
+enum MeshIndexStreams : uint32_t {
+    kMeshIndexedNormals = 1 << 0,
+    kMeshNormalsFollowPoints = 1 << 1,
+    kMeshFlatNormals = 1 << 2,
+    kMeshIndexedUvs = 1 << 3,
+    kMeshUvsFollowPoints = 1 << 4,
+};
+
+struct PolygonIndexStream {
+    VtIntArray const* indices;
+    VtIntArray* out_indices;
+};
+
+// RPR supports only triangles and quads, so polygons with more vertices are split into triangle fans.
+// Also, RPR does not allow to select which winding order we want to use and it's by default right handed.
+// All streams share the same face layout, so face offsets are computed only once for all of them.
+// Returns false and leaves all output buffers empty when any of the streams does not match the face layout.
+bool SplitPolygons(VtIntArray const& vpf, TfToken const& windingOrder, VtIntArray* out_vpf,
+                   PolygonIndexStream* streams, size_t numStreams) {
+    static constexpr size_t kNumFacesPerBlock = 16384;
+
+    auto getNumSplitFaces = [](int vCount) -> size_t {
+        if (vCount == 3 || vCount == 4) return 1;
+        return vCount > 4 ? vCount - 2 : 0;
+    };
+    auto getNumSplitIndices = [](int vCount) -> size_t {
+        if (vCount == 3 || vCount == 4) return vCount;
+        return vCount > 4 ? 3 * (vCount - 2) : 0;
+    };
+
+    const int* vpfData = vpf.cdata();
+    const size_t numFaces = vpf.size();
+    const size_t numBlocks = (numFaces + kNumFacesPerBlock - 1) / kNumFacesPerBlock;
+
+    struct BlockOffsets {
+        size_t srcIndex = 0;
+        size_t dstIndex = 0;
+        size_t dstFace = 0;
+    };
+    std::vector<BlockOffsets> blockOffsets(numBlocks + 1);
+
+    // Count the output size of each block in parallel and turn the counts into offsets with a prefix sum
+    WorkParallelForN(numBlocks,
+        [&](size_t begin, size_t end) {
+            for (size_t iBlock = begin; iBlock < end; ++iBlock) {
+                auto& block = blockOffsets[iBlock + 1];
+                size_t faceEnd = std::min(numFaces, (iBlock + 1) * kNumFacesPerBlock);
+                for (size_t iFace = iBlock * kNumFacesPerBlock; iFace < faceEnd; ++iFace) {
+                    int vCount = vpfData[iFace];
+                    block.srcIndex += std::max(vCount, 0);
+                    block.dstIndex += getNumSplitIndices(vCount);
+                    block.dstFace += getNumSplitFaces(vCount);
+                }
+            }
+        }
+    );
+    for (size_t iBlock = 1; iBlock <= numBlocks; ++iBlock) {
+        blockOffsets[iBlock].srcIndex += blockOffsets[iBlock - 1].srcIndex;
+        blockOffsets[iBlock].dstIndex += blockOffsets[iBlock - 1].dstIndex;
+        blockOffsets[iBlock].dstFace += blockOffsets[iBlock - 1].dstFace;
+    }
+    auto& totals = blockOffsets.back();
+
+    for (size_t iStream = 0; iStream < numStreams; ++iStream) {
+        if (streams[iStream].indices->size() < totals.srcIndex) {
+            TF_RUNTIME_ERROR("Invalid topology: expected at least %zu indices, got %zu", totals.srcIndex, streams[iStream].indices->size());
+            for (size_t i = 0; i < numStreams; ++i) {
+                streams[i].out_indices->clear();
+            }
+            out_vpf->clear();
+            return false;
+        }
+    }
+
+    // Resolve all writable pointers before going parallel to avoid copy-on-write detaches inside of the workers
+    std::vector<int const*> srcData(numStreams, nullptr);
+    std::vector<int*> dstData(numStreams, nullptr);
+    for (size_t iStream = 0; iStream < numStreams; ++iStream) {
+        auto& stream = streams[iStream];
+        stream.out_indices->resize(totals.dstIndex);
+        srcData[iStream] = stream.indices->cdata();
+        dstData[iStream] = stream.out_indices->data();
+    }
+    out_vpf->resize(totals.dstFace);
+    int* dstVpf = out_vpf->data();
+
+    const bool flipWinding = windingOrder != HdTokens->rightHanded;
+
+    WorkParallelForN(numBlocks,
+        [&](size_t begin, size_t end) {
+            for (size_t iBlock = begin; iBlock < end; ++iBlock) {
+                auto offsets = blockOffsets[iBlock];
+                size_t faceEnd = std::min(numFaces, (iBlock + 1) * kNumFacesPerBlock);
+                for (size_t iFace = iBlock * kNumFacesPerBlock; iFace < faceEnd; ++iFace) {
+                    const int vCount = vpfData[iFace];
+                    const size_t numSplitFaces = getNumSplitFaces(vCount);
+
+                    for (size_t iStream = 0; iStream < numStreams; ++iStream) {
+                        auto src = srcData[iStream] + offsets.srcIndex;
+                        auto dst = dstData[iStream] + offsets.dstIndex;
+                        if (numSplitFaces == 1) {
+                            std::copy(src, src + vCount, dst);
+                            if (flipWinding) {
+                                std::swap(dst[0], dst[2]);
+                            }
+                        } else {
+                            for (int i = 1; i < vCount - 1; ++i, dst += 3) {
+                                dst[0] = src[0];
+                                dst[1] = src[i];
+                                dst[2] = src[i + 1];
+                                if (flipWinding) {
+                                    std::swap(dst[0], dst[2]);
+                                }
+                            }
+                        }
+                    }
+
+                    if (numSplitFaces == 1) {
+                        dstVpf[offsets.dstFace] = vCount;
+                    } else {
+                        std::fill(dstVpf + offsets.dstFace, dstVpf + offsets.dstFace + numSplitFaces, 3);
+                    }
+
+                    offsets.srcIndex += std::max(vCount, 0);
+                    offsets.dstIndex += getNumSplitIndices(vCount);
+                    offsets.dstFace += numSplitFaces;
+                }
+            }
+        }
+    );
+
+    return true;
 }
 
 } // namespace anonymous
@@ -496,7 +836,8 @@ public:
     rpr::Shape* CreateMesh(VtVec3fArray const& points, VtIntArray const& pointIndices,
                            VtVec3fArray const& normals, VtIntArray const& normalIndices,
                            VtVec2fArray const& uvs, VtIntArray const& uvIndices,
-                           VtIntArray const& vpf, TfToken const& polygonWinding = HdTokens->rightHanded) {
+                           VtIntArray const& vpf, TfToken const& polygonWinding = HdTokens->rightHanded,
+                           HdRprApiMeshDataState const& dataState = HdRprApiMeshDataState()) {
         VtArray<VtVec3fArray> pointSamples;
         VtArray<VtVec3fArray> normalSamples;
         VtArray<VtVec2fArray> uvSamples;
@@ -505,90 +846,200 @@ public:
         if (!normals.empty()) normalSamples.push_back(normals);
         if (!uvs.empty()) uvSamples.push_back(uvs);
 
-        return CreateMesh(pointSamples, pointIndices, normalSamples, normalIndices, uvSamples, uvIndices, vpf, polygonWinding);
+        return CreateMesh(pointSamples, pointIndices, normalSamples, normalIndices, uvSamples, uvIndices, vpf, polygonWinding, nullptr, dataState);
     }
 
-    rpr::Shape* CreateMesh(VtArray<VtVec3fArray> pointSamples, VtIntArray const& pointIndices,
-                           VtArray<VtVec3fArray> normalSamples, VtIntArray const& normalIndices,
-                           VtArray<VtVec2fArray> uvSamples, VtIntArray const& uvIndices,
-                           VtIntArray const& vpf, TfToken const& polygonWinding) {
+    rpr::Shape* CreateMesh(VtArray<VtVec3fArray> const& pointSamples, VtIntArray const& pointIndices,
+                           VtArray<VtVec3fArray> const& normalSamples, VtIntArray const& normalIndices,
+                           VtArray<VtVec2fArray> const& uvSamples, VtIntArray const& uvIndices,
+                           VtIntArray const& vpf, TfToken const& polygonWinding,
+                           HdRprApiMeshTopology* topology = nullptr,
+                           HdRprApiMeshDataState const& dataState = HdRprApiMeshDataState()) {
         if (!m_rprContext) {
             return nullptr;
         }
 
-        VtIntArray newIndices, newVpf;
-        SplitPolygons(pointIndices, vpf, newIndices, newVpf);
-        ConvertIndices(&newIndices, newVpf, polygonWinding);
+        if (!m_isMeshDeduplicationEnabled) {
+            return CreateUniqueMesh(pointSamples, pointIndices, normalSamples, normalIndices, uvSamples, uvIndices, vpf, polygonWinding, topology);
+        }
 
-        VtIntArray newNormalIndices;
-        if (normalSamples.empty()) {
-            if (RprUsdIsHybrid(m_rprContextMetadata.pluginType)) {
-                // XXX (Hybrid): we need to generate geometry normals by ourself
-                VtVec3fArray normals;
-                normals.reserve(newVpf.size());
-                newNormalIndices.clear();
-                newNormalIndices.reserve(newIndices.size());
-
-                auto& points = pointSamples[0];
-
-                size_t indicesOffset = 0u;
-                for (auto numVerticesPerFace : newVpf) {
-                    for (int i = 0; i < numVerticesPerFace; ++i) {
-                        newNormalIndices.push_back(normals.size());
-                    }
+        return CreateSharedMesh(pointSamples, pointIndices, normalSamples, normalIndices, uvSamples, uvIndices, vpf, polygonWinding, topology, &dataState);
+    }
 
-                    auto indices = &newIndices[indicesOffset];
-                    indicesOffset += numVerticesPerFace;
+    // Meshes of area lights with the same shape are always instances of a single hidden prototype, regardless of the mesh deduplication setting
+    rpr::Shape* CreateLightMesh(VtVec3fArray const& points, VtIntArray const& pointIndices,
+                                VtVec3fArray const& normals, VtIntArray const& normalIndices,
+                                VtIntArray const& vpf, TfToken const& polygonWinding) {
+        if (!m_rprContext) {
+            return nullptr;
+        }
 
-                    auto p0 = points[indices[0]];
-                    auto p1 = points[indices[1]];
-                    auto p2 = points[indices[2]];
+        VtArray<VtVec3fArray> pointSamples;
+        VtArray<VtVec3fArray> normalSamples;
+        if (!points.empty()) pointSamples.push_back(points);
+        if (!normals.empty()) normalSamples.push_back(normals);
 
-                    auto e0 = p0 - p1;
-                    auto e1 = p2 - p1;
+        return CreateSharedMesh(pointSamples, pointIndices, normalSamples, normalIndices, VtArray<VtVec2fArray>(), VtIntArray(), vpf, polygonWinding, nullptr, nullptr);
+    }
+
+    rpr::Shape* CreateSharedMesh(VtArray<VtVec3fArray> const& pointSamples, VtIntArray const& pointIndices,
+                                 VtArray<VtVec3fArray> const& normalSamples, VtIntArray const& normalIndices,
+                                 VtArray<VtVec2fArray> const& uvSamples, VtIntArray const& uvIndices,
+                                 VtIntArray const& vpf, TfToken const& polygonWinding,
+                                 HdRprApiMeshTopology* topology, HdRprApiMeshDataState const* dataState) {
+        // Light meshes are created without the data state, their prototypes are kept apart from the ones of scene meshes
+        MeshDataState prototypeDataState;
+        if (dataState) {
+            prototypeDataState.refineLevel = dataState->refineLevel;
+            prototypeDataState.creaseWeight = dataState->creaseWeight;
+            prototypeDataState.boundaryInterfopType = GetBoundaryInterfopType(dataState->boundaryInterpolation);
+            prototypeDataState.colorsHash = GetVertexColorHash(dataState->colorSamples, dataState->colorInterpolation);
+        }
+
+        HdRprApiMeshTopology localTopology;
+        if (!topology) {
+            topology = &localTopology;
+        }
+
+        // Index buffers are hashed only when they change, point-only updates hash just the vertex data
+        UpdateMeshTopologySource(pointIndices, normalIndices, uvIndices, vpf, polygonWinding, topology);
+        if (!topology->hasContentHash) {
+            MeshContentHasher topologyHasher;
+            topologyHasher.Append(pointIndices);
+            topologyHasher.Append(normalIndices);
+            topologyHasher.Append(uvIndices);
+            topologyHasher.Append(vpf);
+            topologyHasher.Append(polygonWinding.Hash());
+            auto topologyHash = topologyHasher.GetHash();
+            topology->contentHash[0] = topologyHash.first;
+            topology->contentHash[1] = topologyHash.second;
+            topology->contentNumBytes = topologyHasher.GetNumBytes();
+            topology->hasContentHash = true;
+        }
+
+        MeshContentHasher hasher;
+        hasher.Append(size_t(dataState != nullptr));
+        hasher.Append(size_t(prototypeDataState.refineLevel));
+        hasher.Append(&prototypeDataState.creaseWeight, sizeof(prototypeDataState.creaseWeight));
+        hasher.Append(size_t(prototypeDataState.boundaryInterfopType));
+        hasher.Append(prototypeDataState.colorsHash.first);
+        hasher.Append(prototypeDataState.colorsHash.second);
+        hasher.Append(topology->contentHash[0]);
+        hasher.Append(topology->contentHash[1]);
+        hasher.Append(pointSamples);
+        hasher.Append(normalSamples);
+        hasher.Append(uvSamples);
+        auto key = hasher.GetHash();
+
+        MeshPrototypeContent content{
+            pointSamples, pointIndices, normalSamples, normalIndices, uvSamples, uvIndices, vpf, polygonWinding,
+            0, 0.0f, TfToken(), VtArray<VtVec3fArray>(), HdInterpolationConstant, dataState == nullptr};
+        if (dataState) {
+            content.refineLevel = dataState->refineLevel;
+            content.creaseWeight = dataState->creaseWeight;
+            content.boundaryInterpolation = dataState->boundaryInterpolation;
+            content.colorSamples = dataState->colorSamples;
+            content.colorInterpolation = dataState->colorInterpolation;
+        }
+
+        auto createInstance = [&](MeshPrototype* prototype) -> rpr::Shape* {
+            auto instances = CreateSharedMeshInstances(key, prototype, 1);
+            return instances.empty() ? nullptr : instances[0];
+        };
 
-                    auto normal = GfCross(e1, e0);
-                    GfNormalize(&normal);
-                    normals.push_back(normal);
+        bool isHashCollision = false;
+        {
+            LockGuard lock(m_meshPrototypesMutex);
+            auto it = m_meshPrototypes.find(key);
+            if (it != m_meshPrototypes.end()) {
+                if (it->second.content == content) {
+                    return createInstance(&it->second);
                 }
-
-                normalSamples.push_back(normals);
-            }
-        } else {
-            if (!normalIndices.empty()) {
-                SplitPolygons(normalIndices, vpf, newNormalIndices);
-                ConvertIndices(&newNormalIndices, newVpf, polygonWinding);
-            } else {
-                newNormalIndices = newIndices;
+                isHashCollision = true;
             }
         }
 
-        VtIntArray newUvIndices;
-        if (uvSamples.empty()) {
-            if (RprUsdIsHybrid(m_rprContextMetadata.pluginType)) {
-                newUvIndices = newIndices;
-                VtVec2fArray uvs(pointSamples[0].size(), GfVec2f(0.0f));
-                uvSamples.push_back(uvs);
+        // Build the prototype without holding the lock so that unique meshes are still created in parallel
+        auto prototypeMesh = CreateUniqueMesh(pointSamples, pointIndices, normalSamples, normalIndices, uvSamples, uvIndices, vpf, polygonWinding, topology);
+        if (!prototypeMesh || isHashCollision) {
+            // The mesh that collides with the existing prototype is not shared
+            return prototypeMesh;
+        }
+        SetMeshVisibility(prototypeMesh, kInvisible);
+
+        LockGuard lock(m_meshPrototypesMutex);
+        size_t numBytes = hasher.GetNumBytes() + topology->contentNumBytes;
+        auto status = m_meshPrototypes.emplace(key, MeshPrototype{prototypeMesh, 0, numBytes, prototypeDataState, dataState == nullptr, content});
+        if (!status.second) {
+            if (!(status.first->second.content == content)) {
+                // Another rprim has created a colliding prototype in the meantime
+                SetMeshVisibility(prototypeMesh, kVisibleAll);
+                return prototypeMesh;
             }
-        } else {
-            if (!uvIndices.empty()) {
-                SplitPolygons(uvIndices, vpf, newUvIndices);
-                ConvertIndices(&newUvIndices, newVpf, polygonWinding);
-            } else {
-                newUvIndices = newIndices;
+
+            // Another rprim has created the same prototype in the meantime
+            ReleaseUniqueMesh(prototypeMesh);
+        }
+
+        auto prototype = &status.first->second;
+        auto instance = createInstance(prototype);
+        if (!instance && prototype->numUsers == 0) {
+            ReleaseUniqueMesh(prototype->mesh);
+            m_meshPrototypes.erase(status.first);
+        }
+        return instance;
+    }
+
+    rpr::Shape* CreateUniqueMesh(VtArray<VtVec3fArray> pointSamples, VtIntArray const& pointIndices,
+                                 VtArray<VtVec3fArray> normalSamples, VtIntArray const& normalIndices,
+                                 VtArray<VtVec2fArray> uvSamples, VtIntArray const& uvIndices,
+                                 VtIntArray const& vpf, TfToken const& polygonWinding,
+                                 HdRprApiMeshTopology* topology) {
+        const bool isHybrid = RprUsdIsHybrid(m_rprContextMetadata.pluginType);
+
+        uint32_t indexStreams = 0;
+        if (!normalSamples.empty()) {
+            indexStreams |= normalIndices.empty() ? kMeshNormalsFollowPoints : kMeshIndexedNormals;
+        } else if (isHybrid) {
+            // XXX (Hybrid): we need to generate geometry normals by ourself
+            indexStreams |= kMeshFlatNormals;
+        }
+        if (!uvSamples.empty()) {
+            indexStreams |= uvIndices.empty() ? kMeshUvsFollowPoints : kMeshIndexedUvs;
+        } else if (isHybrid) {
+            indexStreams |= kMeshUvsFollowPoints;
+        }
+
+        HdRprApiMeshTopology localTopology;
+        if (!topology) {
+            topology = &localTopology;
+        }
+
+        // Topology conversion is skipped when only the vertex data changed
+        UpdateMeshTopologySource(pointIndices, normalIndices, uvIndices, vpf, polygonWinding, topology);
+        if (!topology->isConverted || topology->indexStreams != indexStreams) {
+            if (!ConvertMeshTopology(indexStreams, topology)) {
+                return nullptr;
             }
         }
 
-        auto normalIndicesData = !newNormalIndices.empty() ? newNormalIndices.data() : newIndices.data();
-        if (normalSamples.empty()) {
-            normalIndicesData = nullptr;
+        VtIntArray const& newIndices = topology->rprPointIndices;
+        VtIntArray const& newNormalIndices = topology->rprNormalIndices;
+        VtIntArray const& newUvIndices = topology->rprUvIndices;
+        VtIntArray const& newVpf = topology->rprVpf;
+
+        if ((indexStreams & kMeshFlatNormals) && !pointSamples.empty()) {
+            normalSamples.push_back(HdRprComputeFlatNormals(newIndices, newNormalIndices, newVpf.size(), pointSamples.cdata()[0]));
         }
 
-        auto uvIndicesData = !newUvIndices.empty() ? newUvIndices.data() : uvIndices.data();
-        if (uvSamples.empty()) {
-            uvIndicesData = nullptr;
+        if (uvSamples.empty() && isHybrid && !pointSamples.empty()) {
+            VtVec2fArray uvs(pointSamples.cdata()[0].size(), GfVec2f(0.0f));
+            uvSamples.push_back(uvs);
         }
 
+        rpr_int const* normalIndicesData = !normalSamples.empty() ? newNormalIndices.cdata() : nullptr;
+        rpr_int const* uvIndicesData = !uvSamples.empty() ? newUvIndices.cdata() : nullptr;
+
         rpr_float const* pointsData = nullptr;
         rpr_float const* normalsData = nullptr;
         rpr_float const* uvsData = nullptr;
@@ -596,11 +1047,9 @@ public:
         size_t numNormals = 0;
         size_t numUvs = 0;
 
-        std::vector<rpr_mesh_info> meshProperties(1, rpr_mesh_info(0));
+        std::vector<rpr_mesh_info> meshProperties(3, rpr_mesh_info(0));
 
-        std::unique_ptr<GfVec3f[]> mergedPoints;
-        std::unique_ptr<GfVec3f[]> mergedNormals;
-        std::unique_ptr<GfVec2f[]> mergedUvs;
+        StagingMemoryPool::Block mergedSamples;
 
         size_t numMeshSamples = std::max(std::max(pointSamples.size(), normalSamples.size()), uvSamples.size());
 
@@ -614,25 +1063,32 @@ public:
             meshProperties[1] = (rpr_mesh_info)numMeshSamples;
             meshProperties[2] = (rpr_mesh_info)0;
 
-            mergedPoints = MergeSamples(&pointSamples, numMeshSamples, &pointsData, &numPoints);
-            mergedNormals = MergeSamples(&normalSamples, numMeshSamples, &normalsData, &numNormals);
-            mergedUvs = MergeSamples(&uvSamples, numMeshSamples, &uvsData, &numUvs);
+            size_t mergedPointsSize = GetMergedSamplesSize(pointSamples, numMeshSamples);
+            size_t mergedNormalsSize = GetMergedSamplesSize(normalSamples, numMeshSamples);
+            size_t mergedUvsSize = GetMergedSamplesSize(uvSamples, numMeshSamples);
+            mergedSamples = m_stagingMemoryPool.Acquire(mergedPointsSize + mergedNormalsSize + mergedUvsSize);
+
+            auto mergedSamplesData = mergedSamples.GetData();
+            MergeSamples(pointSamples, numMeshSamples, mergedSamplesData, &pointsData, &numPoints);
+            MergeSamples(normalSamples, numMeshSamples, mergedSamplesData + mergedPointsSize, &normalsData, &numNormals);
+            MergeSamples(uvSamples, numMeshSamples, mergedSamplesData + mergedPointsSize + mergedNormalsSize, &uvsData, &numUvs);
 
         } else {
             if (pointSamples.empty()) {
                 return nullptr;
             }
-            pointsData = (rpr_float const*)pointSamples[0].cdata();
-            numPoints = pointSamples[0].size();
+            // Access samples through const references, otherwise VtArray would make a copy of the shared data
+            pointsData = (rpr_float const*)pointSamples.cdata()[0].cdata();
+            numPoints = pointSamples.cdata()[0].size();
 
             if (!normalSamples.empty()) {
-                normalsData = (rpr_float const*)normalSamples[0].data();
-                numNormals = normalSamples[0].size();
+                normalsData = (rpr_float const*)normalSamples.cdata()[0].cdata();
+                numNormals = normalSamples.cdata()[0].size();
             }
             
             if (!uvSamples.empty()) {
-                uvsData = (rpr_float const*)uvSamples[0].data();
-                numUvs = uvSamples[0].size();
+                uvsData = (rpr_float const*)uvSamples.cdata()[0].cdata();
+                numUvs = uvSamples.cdata()[0].size();
             }
         }
 
@@ -647,10 +1103,10 @@ public:
             normalsData, numNormals, sizeof(GfVec3f),
             nullptr, 0, 0,
             1, &uvsData, &numUvs, &texCoordStride,
-            newIndices.data(), sizeof(rpr_int),
+            newIndices.cdata(), sizeof(rpr_int),
             normalIndicesData, sizeof(rpr_int),
             &uvIndicesData, &texCoordIdxStride,
-            newVpf.data(), newVpf.size(), meshProperties.data(), &status);
+            newVpf.cdata(), newVpf.size(), meshProperties.data(), &status);
         if (!mesh) {
             RPR_ERROR_CHECK(status, "Failed to create mesh");
             return nullptr;
@@ -664,32 +1120,141 @@ public:
         return mesh;
     }
 
+    // Drops the converted buffers and the content hash of the topology if any of the source buffers changed
+    void UpdateMeshTopologySource(VtIntArray const& pointIndices, VtIntArray const& normalIndices, VtIntArray const& uvIndices,
+                                  VtIntArray const& vpf, TfToken const& polygonWinding,
+                                  HdRprApiMeshTopology* topology) {
+        // VtArray compares the data only when the arrays are not shared, which is the case for point-only updates
+        if (topology->polygonWinding == polygonWinding &&
+            topology->vpf == vpf &&
+            topology->pointIndices == pointIndices &&
+            topology->normalIndices == normalIndices &&
+            topology->uvIndices == uvIndices) {
+            return;
+        }
+
+        *topology = HdRprApiMeshTopology();
+        topology->pointIndices = pointIndices;
+        topology->normalIndices = normalIndices;
+        topology->uvIndices = uvIndices;
+        topology->vpf = vpf;
+        topology->polygonWinding = polygonWinding;
+    }
+
+    // On failure the converted buffers are dropped so that the next CreateMesh call does not reuse them
+    bool ConvertMeshTopology(uint32_t indexStreams, HdRprApiMeshTopology* topology) {
+        topology->isConverted = false;
+        topology->indexStreams = indexStreams;
+        topology->rprPointIndices = VtIntArray();
+        topology->rprNormalIndices = VtIntArray();
+        topology->rprUvIndices = VtIntArray();
+        topology->rprVpf = VtIntArray();
+
+        PolygonIndexStream polygonIndexStreams[3];
+        size_t numPolygonIndexStreams = 0;
+        polygonIndexStreams[numPolygonIndexStreams++] = {&topology->pointIndices, &topology->rprPointIndices};
+        if (indexStreams & kMeshIndexedNormals) {
+            polygonIndexStreams[numPolygonIndexStreams++] = {&topology->normalIndices, &topology->rprNormalIndices};
+        }
+        if (indexStreams & kMeshIndexedUvs) {
+            polygonIndexStreams[numPolygonIndexStreams++] = {&topology->uvIndices, &topology->rprUvIndices};
+        }
+        if (!SplitPolygons(topology->vpf, topology->polygonWinding, &topology->rprVpf, polygonIndexStreams, numPolygonIndexStreams)) {
+            return false;
+        }
+
+        if (indexStreams & kMeshNormalsFollowPoints) {
+            topology->rprNormalIndices = topology->rprPointIndices;
+        } else if (indexStreams & kMeshFlatNormals) {
+            // One normal per face
+            auto& rprVpf = topology->rprVpf;
+            topology->rprNormalIndices.resize(topology->rprPointIndices.size());
+            auto normalIndicesData = topology->rprNormalIndices.data();
+            for (size_t iFace = 0; iFace < rprVpf.size(); ++iFace) {
+                normalIndicesData = std::fill_n(normalIndicesData, rprVpf.cdata()[iFace], static_cast<int>(iFace));
+            }
+        }
+
+        if (indexStreams & kMeshUvsFollowPoints) {
+            topology->rprUvIndices = topology->rprPointIndices;
+        }
+
+        topology->isConverted = true;
+        return true;
+    }
+
     rpr::Shape* CreateMeshInstance(rpr::Shape* prototype) {
-        if (!m_rprContext) {
-            return nullptr;
+        auto instances = CreateMeshInstances(prototype, 1);
+        return instances.empty() ? nullptr : instances[0];
+    }
+
+    std::vector<rpr::Shape*> CreateMeshInstances(rpr::Shape* prototype, size_t numInstances) {
+        if (m_rprContext && numInstances != 0) {
+            // RPR can't instance an instance, deduplicated meshes are instanced through their shared prototype
+            LockGuard lock(m_meshPrototypesMutex);
+            auto it = m_deduplicatedMeshes.find(prototype);
+            if (it != m_deduplicatedMeshes.end()) {
+                auto prototypeIt = m_meshPrototypes.find(it->second);
+                if (prototypeIt != m_meshPrototypes.end()) {
+                    return CreateSharedMeshInstances(prototypeIt->first, &prototypeIt->second, numInstances);
+                }
+            }
         }
 
+        return CreateUniqueMeshInstances(prototype, numInstances);
+    }
+
+    // Must be called with m_meshPrototypesMutex locked.
+    // The instances keep the prototype alive the same way as deduplicated meshes do
+    std::vector<rpr::Shape*> CreateSharedMeshInstances(MeshContentHash const& key, MeshPrototype* prototype, size_t numInstances) {
+        auto instances = CreateUniqueMeshInstances(prototype->mesh, numInstances);
+        prototype->numUsers += instances.size();
+        for (auto instance : instances) {
+            m_deduplicatedMeshes.emplace(instance, key);
+        }
+        return instances;
+    }
+
+    std::vector<rpr::Shape*> CreateUniqueMeshInstances(rpr::Shape* prototype, size_t numInstances) {
+        std::vector<rpr::Shape*> instances;
+        if (!m_rprContext || numInstances == 0) {
+            return instances;
+        }
+        instances.reserve(numInstances);
+
         LockGuard rprLock(m_rprContext->GetMutex());
 
-        rpr::Status status;
-        auto mesh = m_rprContext->CreateShapeInstance(prototype, &status);
-        if (!mesh) {
-            RPR_ERROR_CHECK(status, "Failed to create mesh instance");
-            return nullptr;
+        for (size_t i = 0; i < numInstances; ++i) {
+            rpr::Status status;
+            auto mesh = m_rprContext->CreateShapeInstance(prototype, &status);
+            if (!mesh) {
+                RPR_ERROR_CHECK(status, "Failed to create mesh instance");
+                break;
+            }
+
+            if (RPR_ERROR_CHECK(m_scene->Attach(mesh), "Failed to attach mesh to scene")) {
+                delete mesh;
+                break;
+            }
+            instances.push_back(mesh);
         }
 
-        if (RPR_ERROR_CHECK(m_scene->Attach(mesh), "Failed to attach mesh to scene")) {
-            delete mesh;
-            return nullptr;
+        if (!instances.empty()) {
+            m_dirtyFlags |= ChangeTracker::DirtyScene;
         }
-        m_dirtyFlags |= ChangeTracker::DirtyScene;
-        return mesh;
+        return instances;
     }
 
     void SetMeshRefineLevel(rpr::Shape* mesh, const int level, const float creaseWeight) {
         if (!m_rprContext) {
             return;
         }
+        mesh = GetMeshDataOwner(mesh, [&](MeshDataState const& dataState) {
+            return dataState.refineLevel == level && dataState.creaseWeight == creaseWeight;
+        });
+        if (!mesh) {
+            return;
+        }
 
         if (RprUsdIsHybrid(m_rprContextMetadata.pluginType)) {
             // Not supported
@@ -725,6 +1290,26 @@ public:
         }
     }
 
+    // Subdivision and vertex colors belong to the mesh data, so deduplicated meshes forward them to the shared prototype.
+    // The prototype is shared only by the meshes created with the same data state, any other write is rejected
+    // because it would override the state of the other meshes. Returns nullptr in such a case
+    template <typename MatchesDataState>
+    rpr::Shape* GetMeshDataOwner(rpr::Shape* mesh, MatchesDataState&& matchesDataState) {
+        LockGuard lock(m_meshPrototypesMutex);
+        auto it = m_deduplicatedMeshes.find(mesh);
+        if (it != m_deduplicatedMeshes.end()) {
+            auto prototypeIt = m_meshPrototypes.find(it->second);
+            if (prototypeIt != m_meshPrototypes.end()) {
+                if (!matchesDataState(prototypeIt->second.dataState)) {
+                    TF_CODING_ERROR("Data state of a deduplicated mesh can be changed only by creating a new mesh");
+                    return nullptr;
+                }
+                return prototypeIt->second.mesh;
+            }
+        }
+        return mesh;
+    }
+
     void SetMeshVertexInterpolationRule(rpr::Shape* mesh, TfToken const& boundaryInterpolation) {
         if (!m_rprContext) {
             return;
@@ -735,9 +1320,13 @@ public:
             return;
         }
 
-        rpr_subdiv_boundary_interfop_type newInterfopType = boundaryInterpolation == PxOsdOpenSubdivTokens->edgeAndCorner ?
-            RPR_SUBDIV_BOUNDARY_INTERFOP_TYPE_EDGE_AND_CORNER :
-            RPR_SUBDIV_BOUNDARY_INTERFOP_TYPE_EDGE_ONLY;
+        rpr_subdiv_boundary_interfop_type newInterfopType = GetBoundaryInterfopType(boundaryInterpolation);
+        mesh = GetMeshDataOwner(mesh, [&](MeshDataState const& dataState) {
+            return dataState.boundaryInterfopType == newInterfopType;
+        });
+        if (!mesh) {
+            return;
+        }
 
         LockGuard rprLock(m_rprContext->GetMutex());
 
@@ -814,6 +1403,30 @@ public:
     }
 
     void Release(rpr::Shape* shape) {
+        if (!shape) {
+            return;
+        }
+
+        {
+            LockGuard lock(m_meshPrototypesMutex);
+            auto it = m_deduplicatedMeshes.find(shape);
+            if (it != m_deduplicatedMeshes.end()) {
+                auto prototypeIt = m_meshPrototypes.find(it->second);
+                m_deduplicatedMeshes.erase(it);
+
+                ReleaseUniqueMesh(shape);
+                if (prototypeIt != m_meshPrototypes.end() && --prototypeIt->second.numUsers == 0) {
+                    ReleaseUniqueMesh(prototypeIt->second.mesh);
+                    m_meshPrototypes.erase(prototypeIt);
+                }
+                return;
+            }
+        }
+
+        ReleaseUniqueMesh(shape);
+    }
+
+    void ReleaseUniqueMesh(rpr::Shape* shape) {
         if (shape) {
             LockGuard rprLock(m_rprContext->GetMutex());
 
@@ -826,6 +1439,23 @@ public:
 
     void SetMeshVisibility(rpr::Shape* mesh, uint32_t visibilityMask) {
         LockGuard rprLock(m_rprContext->GetMutex());
+        SetMeshVisibilityLocked(mesh, visibilityMask);
+    }
+
+    void SetMeshVisibility(rpr::Shape* const* meshes, size_t numMeshes, uint32_t visibilityMask) {
+        if (numMeshes == 0) {
+            return;
+        }
+
+        LockGuard rprLock(m_rprContext->GetMutex());
+        for (size_t i = 0; i < numMeshes; ++i) {
+            if (meshes[i]) {
+                SetMeshVisibilityLocked(meshes[i], visibilityMask);
+            }
+        }
+    }
+
+    void SetMeshVisibilityLocked(rpr::Shape* mesh, uint32_t visibilityMask) {
         if (RprUsdIsHybrid(m_rprContextMetadata.pluginType)) {
             // XXX (Hybrid): rprShapeSetVisibility not supported, emulate visibility using attach/detach
             if (visibilityMask) {
@@ -856,6 +1486,19 @@ public:
         RPR_ERROR_CHECK(mesh->SetObjectID(id), "Failed to set mesh id");
     }
 
+    void SetMeshIds(rpr::Shape* const* meshes, size_t numMeshes, uint32_t firstId) {
+        if (numMeshes == 0) {
+            return;
+        }
+
+        LockGuard rprLock(m_rprContext->GetMutex());
+        for (size_t i = 0; i < numMeshes; ++i) {
+            if (meshes[i]) {
+                RPR_ERROR_CHECK(meshes[i]->SetObjectID(firstId + uint32_t(i)), "Failed to set mesh id");
+            }
+        }
+    }
+
     void SetMeshIgnoreContour(rpr::Shape* mesh, bool ignoreContour) {
         if (m_rprContextMetadata.pluginType == kPluginNorthstar) {
             LockGuard rprLock(m_rprContext->GetMutex());
@@ -874,6 +1517,12 @@ public:
         if (primvarSamples.empty()) {
             return false;
         }
+        mesh = GetMeshDataOwner(mesh, [&](MeshDataState const& dataState) {
+            return dataState.colorsHash == GetVertexColorHash(primvarSamples, interpolation);
+        });
+        if (!mesh) {
+            return false;
+        }
         if (m_rprContextMetadata.pluginType == kPluginNorthstar) {
             LockGuard rprLock(m_rprContext->GetMutex());
 
@@ -1077,10 +1726,10 @@ public:
             return nullptr;
         }
 
-        LockGuard rprLock(m_rprContext->GetMutex());
-
-        auto material = HdRprApiRawMaterial::Create(m_rprContext.get(), RPR_MATERIAL_NODE_EMISSIVE, {
-            {RPR_MATERIAL_INPUT_COLOR, ToVec4(emissionColor, 1.0f)}
+        auto material = AcquirePooledMaterial(PooledMaterialKey(PooledMaterialType::Emissive, emissionColor[0], emissionColor[1], emissionColor[2]), [&]() {
+            return CreateRawMaterial(RPR_MATERIAL_NODE_EMISSIVE, {
+                {RPR_MATERIAL_INPUT_COLOR, ToVec4(emissionColor, 1.0f)}
+            });
         });
         if (material) m_numLights++;
         return material;
@@ -1307,7 +1956,7 @@ public:
         }
     }
 
-    void SetTransform(rpr::Shape* shape, size_t numSamples, float* timeSamples, GfMatrix4d* transformSamples) {
+    void SetTransform(rpr::Shape* shape, size_t numSamples, float const* timeSamples, GfMatrix4d const* transformSamples) {
         // TODO: Implement C++ wrapper methods
         auto rprShapeHandle = rpr::GetRprObject(shape);
 
@@ -1345,6 +1994,73 @@ public:
         m_dirtyFlags |= ChangeTracker::DirtyScene;
     }
 
+    void SetTransforms(rpr::Shape* const* shapes, size_t numShapes, size_t numSamples, float const* timeSamples, GfMatrix4d const* transformSamples) {
+        if (numShapes == 0 || numSamples == 0) {
+            return;
+        }
+
+        // Same as SetTransform for each shape, but the transforms are decomposed in parallel and applied under a single lock
+        struct ShapeTransform {
+            GfMatrix4f start;
+            GfMatrix4f end;
+            GfVec3f linearMotion;
+            GfVec3f scaleMotion;
+            GfVec3f rotateAxis;
+            float rotateAngle;
+        };
+        std::vector<ShapeTransform> shapeTransforms(numShapes);
+
+        bool isNorthstar = m_rprContextMetadata.pluginType == kPluginNorthstar;
+        WorkParallelForN(numShapes,
+            [&](size_t begin, size_t end) {
+                for (size_t i = begin; i < end; ++i) {
+                    auto shapeTransformSamples = transformSamples + i * numSamples;
+                    auto& shapeTransform = shapeTransforms[i];
+                    if (numSamples == 1) {
+                        shapeTransform.start = GfMatrix4f(shapeTransformSamples[0]) * GfMatrix4f(m_unitSizeTransform);
+                        continue;
+                    }
+
+                    // XXX (RPR): for the moment, RPR supports only 1 motion matrix
+                    auto startTransform = shapeTransformSamples[0] * m_unitSizeTransform;
+                    auto endTransform = shapeTransformSamples[numSamples - 1] * m_unitSizeTransform;
+                    shapeTransform.start = GfMatrix4f(startTransform);
+                    if (isNorthstar) {
+                        shapeTransform.end = GfMatrix4f(endTransform);
+                    } else {
+                        GetMotion(startTransform, endTransform, &shapeTransform.linearMotion, &shapeTransform.scaleMotion, &shapeTransform.rotateAxis, &shapeTransform.rotateAngle);
+                    }
+                }
+            }
+        );
+
+        LockGuard rprLock(m_rprContext->GetMutex());
+
+        for (size_t i = 0; i < numShapes; ++i) {
+            auto shape = shapes[i];
+            if (!shape) {
+                continue;
+            }
+            auto& shapeTransform = shapeTransforms[i];
+            auto rprShapeHandle = rpr::GetRprObject(shape);
+
+            if (numSamples == 1) {
+                RPR_ERROR_CHECK(rprShapeSetMotionTransformCount(rprShapeHandle, 0), "Failed to set shape motion transform count");
+                RPR_ERROR_CHECK(shape->SetTransform(shapeTransform.start.GetArray(), false), "Fail set shape transform");
+            } else if (isNorthstar) {
+                RPR_ERROR_CHECK(shape->SetTransform(shapeTransform.start.GetArray(), false), "Fail set shape transform");
+                RPR_ERROR_CHECK(rprShapeSetMotionTransformCount(rprShapeHandle, 1), "Failed to set shape motion transform count");
+                RPR_ERROR_CHECK(rprShapeSetMotionTransform(rprShapeHandle, false, shapeTransform.end.GetArray(), 1), "Failed to set shape motion transform count");
+            } else {
+                RPR_ERROR_CHECK(shape->SetTransform(shapeTransform.start.GetArray(), false), "Fail set shape transform");
+                RPR_ERROR_CHECK(shape->SetLinearMotion(shapeTransform.linearMotion[0], shapeTransform.linearMotion[1], shapeTransform.linearMotion[2]), "Fail to set shape linear motion");
+                RPR_ERROR_CHECK(shape->SetScaleMotion(shapeTransform.scaleMotion[0], shapeTransform.scaleMotion[1], shapeTransform.scaleMotion[2]), "Fail to set shape scale motion");
+                RPR_ERROR_CHECK(shape->SetAngularMotion(shapeTransform.rotateAxis[0], shapeTransform.rotateAxis[1], shapeTransform.rotateAxis[2], shapeTransform.rotateAngle), "Fail to set shape angular motion");
+            }
+        }
+        m_dirtyFlags |= ChangeTracker::DirtyScene;
+    }
+
     RprUsdMaterial* CreateMaterial(SdfPath const& materialId, HdSceneDelegate* sceneDelegate, HdMaterialNetworkMap const& materialNetwork) {
         if (!m_rprContext) {
             return nullptr;
@@ -1419,11 +2135,29 @@ public:
         }
     }
 
+    RprUsdMaterial* CreateDiffuseMaterial(GfVec3f const& color) {
+        if (!m_rprContext) {
+            return nullptr;
+        }
+
+        return AcquirePooledMaterial(PooledMaterialKey(PooledMaterialType::Diffuse, color[0], color[1], color[2]), [&]() {
+            return CreateRawMaterial(RPR_MATERIAL_NODE_UBERV2, {
+                {RPR_MATERIAL_INPUT_UBER_DIFFUSE_COLOR, ToVec4(color, 1.0f)}
+            });
+        });
+    }
+
     RprUsdMaterial* CreatePrimvarColorLookupMaterial() {
         if (!m_rprContext) {
             return nullptr;
         }
 
+        return AcquirePooledMaterial(PooledMaterialKey(PooledMaterialType::PrimvarColorLookup, 0.0f, 0.0f, 0.0f), [this]() {
+            return CreateUniquePrimvarColorLookupMaterial();
+        });
+    }
+
+    RprUsdMaterial* CreateUniquePrimvarColorLookupMaterial() {
         LockGuard rprLock(m_rprContext->GetMutex());
 
         class HdRprApiPrimvarColorLookupMaterial : public RprUsdMaterial {
@@ -1478,21 +2212,115 @@ public:
         return HdRprApiRawMaterial::Create(m_rprContext.get(), nodeType, inputs);
     }
 
-    void Release(RprUsdMaterial* material) {
-        if (material) {
+    enum class PooledMaterialType {
+        Diffuse,
+        Emissive,
+        PrimvarColorLookup
+    };
+    using PooledMaterialKey = std::tuple<PooledMaterialType, float, float, float>;
+
+    // Materials that depend only on their kind and a color are shared by all rprims and lights that request them
+    RprUsdMaterial* AcquirePooledMaterial(PooledMaterialKey const& key, std::function<RprUsdMaterial*()> const& createMaterial) {
+        {
+            LockGuard lock(m_materialPoolMutex);
+            auto it = m_materialPool.find(key);
+            if (it != m_materialPool.end()) {
+                it->second.numUsers++;
+                m_numMaterialPoolHits++;
+                return it->second.material;
+            }
+        }
+
+        // Create the material without holding the lock so that materials with different keys are still created in parallel
+        auto material = createMaterial();
+        if (!material) {
+            return nullptr;
+        }
+
+        // Pooled materials are shared, so they are named after their key rather than after any of their users
+        if (RprUsdIsLeakCheckEnabled()) {
+            static const char* kPooledMaterialTypeNames[] = {"diffuse", "emissive", "primvarColorLookup"};
+            auto name = TfStringPrintf("pooled_%s_%g_%g_%g", kPooledMaterialTypeNames[int(std::get<0>(key))], std::get<1>(key), std::get<2>(key), std::get<3>(key));
+
+            LockGuard rprLock(m_rprContext->GetMutex());
+            material->SetName(name.c_str());
+        }
+
+        LockGuard lock(m_materialPoolMutex);
+        auto status = m_materialPool.emplace(key, PooledMaterial{material, 0});
+        if (status.second) {
+            m_pooledMaterials.emplace(material, key);
+            m_numMaterialPoolMisses++;
+        } else {
+            // Another rprim has created the same material in the meantime
             LockGuard rprLock(m_rprContext->GetMutex());
             delete material;
+            m_numMaterialPoolHits++;
+        }
+
+        auto& pooledMaterial = status.first->second;
+        pooledMaterial.numUsers++;
+        return pooledMaterial.material;
+    }
+
+    void Release(RprUsdMaterial* material) {
+        if (!material) {
+            return;
+        }
+
+        {
+            LockGuard lock(m_materialPoolMutex);
+            auto it = m_pooledMaterials.find(material);
+            if (it != m_pooledMaterials.end()) {
+                auto poolIt = m_materialPool.find(it->second);
+                if (poolIt != m_materialPool.end() && --poolIt->second.numUsers > 0) {
+                    return;
+                }
+
+                if (poolIt != m_materialPool.end()) {
+                    m_materialPool.erase(poolIt);
+                }
+                m_pooledMaterials.erase(it);
+            }
         }
+
+        LockGuard rprLock(m_rprContext->GetMutex());
+        delete material;
     }
 
-    HdRprApiVolume* CreateVolume(VtUIntArray const& densityCoords, VtFloatArray const& densityValues, VtVec3fArray const& densityLUT, float densityScale,
-                                 VtUIntArray const& albedoCoords, VtFloatArray const& albedoValues, VtVec3fArray const& albedoLUT, float albedoScale,
-                                 VtUIntArray const& emissionCoords, VtFloatArray const& emissionValues, VtVec3fArray const& emissionLUT, float emissionScale,
+    HdRprApiVolume* CreateVolume(HdRprApiVolumeGridIndices const& densityIndices, VtFloatArray* densityValues, VtVec3fArray const& densityLUT, float densityScale,
+                                 HdRprApiVolumeGridIndices const& albedoIndices, VtFloatArray const& albedoValues, VtVec3fArray const& albedoLUT, float albedoScale,
+                                 HdRprApiVolumeGridIndices const& emissionIndices, VtFloatArray const& emissionValues, VtVec3fArray const& emissionLUT, float emissionScale,
                                  const GfVec3i& gridSize, const GfVec3f& voxelSize, const GfVec3f& gridBBLow) {
-        if (!m_rprContext) {
+        if (!m_rprContext || densityIndices.empty() || densityLUT.empty()) {
             return nullptr;
         }
 
+        //Northstar does not support density lookup, so we need to compute values.
+        //The values are remapped in-place to not allocate another grid-sized buffer
+        auto values = densityValues->data();
+        WorkParallelForN(densityValues->size(),
+            [&](size_t begin, size_t end) {
+                for (size_t idx = begin; idx < end; ++idx) {
+                    float value = values[idx];
+                    if (value < 0 || densityLUT.size() == 1) {
+                        values[idx] = densityLUT[0][0];
+                        continue;
+                    }
+                    if (value >= 1) {
+                        values[idx] = densityLUT.back()[0];
+                        continue;
+                    }
+                    size_t lookupIndex = floor(value * (densityLUT.size() - 1));
+
+                    //linear interpolation
+                    float firstValue = densityLUT[lookupIndex][0];
+                    float secondValue = densityLUT[lookupIndex + 1][0];
+                    values[idx] = firstValue + (secondValue - firstValue) * (value * densityLUT.size() - lookupIndex);
+                }
+            }
+        );
+
         LockGuard rprLock(m_rprContext->GetMutex());
 
         auto rprApiVolume = new HdRprApiVolume;
@@ -1503,31 +2331,16 @@ public:
         rprApiVolume->volumeShader.reset(m_rprContext->CreateMaterialNode(RPR_MATERIAL_NODE_VOLUME, &status));
         rprApiVolume->densityGridShader.reset(m_rprContext->CreateMaterialNode(RPR_MATERIAL_NODE_GRID_SAMPLER, &status));
 
-        //Northstar does not support density lookup, so we need to compute values
-        std::vector<float> computedDensityValues;
-        computedDensityValues.resize(densityValues.size());
-
-        for (int idx = 0; idx < densityValues.size(); idx++) {
-            if (densityValues[idx] < 0) {
-                computedDensityValues[idx] = densityLUT[0][0];
-                continue;
-            }
-            if (densityValues[idx] >= 1) {
-                computedDensityValues[idx] = densityLUT.back()[0];
-                continue;
-            }
-            size_t lookupIndex = floor(densityValues[idx] * (densityLUT.size() - 1));
-            
-            //linear interpolation
-            float firstValue = densityLUT[lookupIndex][0];
-            float secondValue = densityLUT[lookupIndex + 1][0];
-            computedDensityValues[idx] = firstValue + (secondValue - firstValue) * (densityValues[idx] * densityLUT.size() - lookupIndex);
+        if (densityIndices.indices64.empty()) {
+            rprApiVolume->densityGrid.reset(m_rprContext->CreateGrid(gridSize[0], gridSize[1], gridSize[2],
+                densityIndices.indices32.cdata(), densityIndices.indices32.size(), RPR_GRID_INDICES_TOPOLOGY_I_U32,
+                densityValues->cdata(), densityValues->size() * sizeof(float), 0, &status));
+        } else {
+            rprApiVolume->densityGrid.reset(m_rprContext->CreateGrid(gridSize[0], gridSize[1], gridSize[2],
+                densityIndices.indices64.cdata(), densityIndices.indices64.size(), RPR_GRID_INDICES_TOPOLOGY_I_U64,
+                densityValues->cdata(), densityValues->size() * sizeof(float), 0, &status));
         }
 
-        rprApiVolume->densityGrid.reset(m_rprContext->CreateGrid(gridSize[0], gridSize[1], gridSize[2],
-            &densityCoords[0], densityCoords.size() / 3, RPR_GRID_INDICES_TOPOLOGY_XYZ_U32,
-            &computedDensityValues[0], computedDensityValues.size() * sizeof(computedDensityValues[0]), 0, &status));
-
         // these objects are required to correctly create volume
         if (!rprApiVolume->densityGridShader ||
             !rprApiVolume->volumeShader ||
@@ -1550,7 +2363,7 @@ public:
             outImage.reset(m_rprContext->CreateImage({ 3, RPR_COMPONENT_TYPE_FLOAT32 }, lookupImageDesc, (float*)LUT.data(), imageStatus));
         };
 
-        if (!emissionCoords.empty()) {
+        if (!emissionIndices.empty()) {
             rprApiVolume->emissionLookupShader.reset(m_rprContext->CreateMaterialNode(RPR_MATERIAL_NODE_IMAGE_TEXTURE, &status));
             createLookupTexture(emissionLUT, rprApiVolume->emissionLookupRamp, &status);
 
@@ -1566,7 +2379,7 @@ public:
             }
         }
         
-        if (!albedoCoords.empty()) {
+        if (!albedoIndices.empty()) {
             rprApiVolume->albedoLookupShader.reset(m_rprContext->CreateMaterialNode(RPR_MATERIAL_NODE_IMAGE_TEXTURE, &status));
             createLookupTexture(albedoLUT, rprApiVolume->albedoLookupRamp, &status);
             
@@ -1649,6 +2462,68 @@ public:
         return m_hdCamera;
     }
 
+    bool GetDeformationSampleTimes(size_t numSamples, float* sampleTimes) const {
+        // Only Northstar renders deformation motion blur
+        if (m_rprContextMetadata.pluginType != kPluginNorthstar ||
+            !m_hdCamera || numSamples < 2 || m_framesPerSecond <= 0.0f) {
+            return false;
+        }
+
+        double shutterOpen = 0.0;
+        double shutterClose = 0.0;
+        m_hdCamera->GetShutterOpen(&shutterOpen);
+        m_hdCamera->GetShutterClose(&shutterClose);
+        if (shutterClose <= shutterOpen) {
+            return false;
+        }
+
+        // Shutter is specified in frames
+        double step = (shutterClose - shutterOpen) / (numSamples - 1);
+        for (size_t i = 0; i < numSamples; ++i) {
+            sampleTimes[i] = float((shutterOpen + step * i) / m_framesPerSecond);
+        }
+        return true;
+    }
+
+    double GetProjectedSize(GfBBox3d const& bbox) const {
+        if (!m_hdCamera) {
+            return -1.0;
+        }
+
+        auto const& range = bbox.GetRange();
+        if (range.IsEmpty()) {
+            return 0.0;
+        }
+
+#if PXR_VERSION >= 2203
+        GfMatrix4d projectionMatrix = m_hdCamera->ComputeProjectionMatrix();
+#else
+        GfMatrix4d projectionMatrix = m_hdCamera->GetProjectionMatrix();
+#endif
+        if (m_viewportSize[0] > 0 && m_viewportSize[1] > 0) {
+            auto aspectRatio = double(m_viewportSize[0]) / m_viewportSize[1];
+            projectionMatrix = CameraUtilConformedWindow(projectionMatrix, m_hdCamera->GetWindowPolicy(), aspectRatio);
+        }
+
+        // Camera transform and the bounding box are in the same space, so m_unitSizeTransform does not affect the projection
+        GfMatrix4d localToClip = bbox.GetMatrix() * m_hdCamera->GetTransform().GetInverse() * projectionMatrix;
+
+        GfRange2d ndcRange;
+        for (size_t i = 0; i < 8; ++i) {
+            auto corner = range.GetCorner(i);
+            auto clip = GfVec4d(corner[0], corner[1], corner[2], 1.0) * localToClip;
+            if (clip[3] <= 0.0) {
+                // The bounding box crosses the camera plane
+                return std::numeric_limits<double>::max();
+            }
+            ndcRange.UnionWith(GfVec2d(clip[0] / clip[3], clip[1] / clip[3]));
+        }
+
+        // NDC range is [-1; 1]
+        auto ndcSize = ndcRange.GetSize();
+        return std::max(ndcSize[0], ndcSize[1]) * 0.5;
+    }
+
     GfMatrix4d GetCameraViewMatrix() const {
         return m_hdCamera ? (m_hdCamera->GetTransform() * m_unitSizeTransform).GetInverse() : GfMatrix4d(1.0);
     }
@@ -2238,6 +3113,37 @@ public:
     }
 
     void UpdateSettings(HdRprConfig const& preferences, bool force = false) {
+        if (preferences.IsDirty(HdRprConfig::DirtyGeometry) || force) {
+            bool isRprimResyncRequired =
+                m_isCpuSubdivisionEnabled != preferences.GetGeometryCpuSubdivision() ||
+                m_isAdaptiveSubdivisionEnabled != preferences.GetGeometryAdaptiveSubdivision() ||
+                m_isHairLodEnabled != preferences.GetGeometryHairLod() ||
+                m_hairLodStrandsPerPixel != preferences.GetGeometryHairLodStrandsPerPixel();
+
+            m_isMeshDeduplicationEnabled = preferences.GetGeometryDeduplicateMeshes();
+            m_isCpuGeometryReleaseEnabled = preferences.GetGeometryReleaseCpuData();
+            m_isCpuSubdivisionEnabled = preferences.GetGeometryCpuSubdivision();
+            m_isAdaptiveSubdivisionEnabled = preferences.GetGeometryAdaptiveSubdivision();
+            m_isHairLodEnabled = preferences.GetGeometryHairLod();
+            m_hairLodStrandsPerPixel = preferences.GetGeometryHairLodStrandsPerPixel();
+
+            // Rprims that are not changed by the scene are resynced by the render pass to apply the new settings.
+            // The version is bumped after the new values are stored so that the resynced rprims read them
+            if (isRprimResyncRequired && !force) {
+                ++m_geometrySettingsVersion;
+            }
+        }
+
+        if (preferences.IsDirty(HdRprConfig::DirtyVolume) || force) {
+            m_volumeGridCacheBudgetMb = preferences.GetVolumeGridCacheBudgetMb();
+            m_volumeVoxelBudgetMillions = preferences.GetVolumeVoxelBudget();
+            m_volumePrefetchFrames = preferences.GetVolumePrefetchFrames();
+        }
+
+        if (preferences.IsDirty(HdRprConfig::DirtyMotionBlur) || force) {
+            m_framesPerSecond = preferences.GetMotionBlurFramesPerSecond();
+        }
+
         if (preferences.IsDirty(HdRprConfig::DirtySampling) || force) {
             m_maxSamples = preferences.GetMaxSamples();
             if (m_maxSamples < m_numSamples) {
@@ -3463,6 +4369,9 @@ Don't show this message again?
         }
 
         RprUsdMaterialRegistry::GetInstance().CommitResources(m_imageCache.get());
+
+        // Sync has finished, staging memory is not needed until the next one
+        m_stagingMemoryPool.Trim();
     }
 
     void Resolve(SdfPath const& aovId) {
@@ -3548,6 +4457,34 @@ Don't show this message again?
         stats.syncTime = (double)m_syncTime.count() / 1000000000.0;
         stats.cacheCreationTime = (double)m_cacheCreationTime.count() / 1000000000.0;
 
+        {
+            LockGuard lock(m_meshPrototypesMutex);
+            for (auto& entry : m_meshPrototypes) {
+                auto& prototype = entry.second;
+                if (prototype.isLightMesh) {
+                    stats.numSharedLightMeshes += prototype.numUsers;
+                } else if (prototype.numUsers > 1) {
+                    stats.numDeduplicatedMeshes += prototype.numUsers - 1;
+                    stats.deduplicatedMeshBytes += (prototype.numUsers - 1) * prototype.numBytes;
+                }
+            }
+        }
+        stats.peakStagingMemoryBytes = m_stagingMemoryPool.GetPeakSize();
+        stats.residentMeshBytes = std::max(int64_t(0), m_residentMeshBytes.load());
+        stats.residentCurvesBytes = std::max(int64_t(0), m_residentCurvesBytes.load());
+        stats.residentPointsBytes = std::max(int64_t(0), m_residentPointsBytes.load());
+        stats.numRefinedTriangles = std::max(int64_t(0), m_numRefinedTriangles.load());
+        stats.numUpdatedInstanceTransforms = m_numUpdatedInstanceTransforms.load();
+        stats.numSkippedInstanceTransforms = m_numSkippedInstanceTransforms.load();
+        stats.numRetainedHairStrands = std::max(int64_t(0), m_numRetainedHairStrands.load());
+        stats.hairLodSavedBytes = std::max(int64_t(0), m_hairLodSavedBytes.load());
+        {
+            LockGuard lock(m_materialPoolMutex);
+            stats.numPooledMaterials = m_materialPool.size();
+        }
+        stats.numMaterialPoolHits = m_numMaterialPoolHits.load();
+        stats.numMaterialPoolMisses = m_numMaterialPoolMisses.load();
+
         return stats;
     }
 
@@ -3595,6 +4532,75 @@ Don't show this message again?
         return !RprUsdIsHybrid(m_rprContextMetadata.pluginType);
     }
 
+    bool IsMeshDeduplicationEnabled() const {
+        return m_isMeshDeduplicationEnabled;
+    }
+
+    bool IsCpuGeometryReleaseEnabled() const {
+        return m_isCpuGeometryReleaseEnabled;
+    }
+
+    bool IsCpuSubdivisionEnabled() const {
+        return m_isCpuSubdivisionEnabled;
+    }
+
+    bool IsAdaptiveSubdivisionEnabled() const {
+        return m_isAdaptiveSubdivisionEnabled;
+    }
+
+    bool IsHairLodEnabled() const {
+        return m_isHairLodEnabled;
+    }
+
+    uint32_t GetGeometrySettingsVersion() const {
+        return m_geometrySettingsVersion;
+    }
+
+    float GetHairLodStrandsPerPixel() const {
+        return m_hairLodStrandsPerPixel;
+    }
+
+    int GetVolumeGridCacheBudgetMb() const {
+        return m_volumeGridCacheBudgetMb;
+    }
+
+    size_t GetVolumeVoxelBudget() const {
+        if (m_isBatch) {
+            return 0;
+        }
+        return size_t(m_volumeVoxelBudgetMillions) * 1000000;
+    }
+
+    int GetVolumePrefetchFrames() const {
+        return m_volumePrefetchFrames;
+    }
+
+    void UpdateRefinedTriangleCount(int64_t deltaTriangles) {
+        m_numRefinedTriangles += deltaTriangles;
+    }
+
+    void UpdateHairLodStats(int64_t deltaRetainedStrands, int64_t deltaSavedBytes) {
+        m_numRetainedHairStrands += deltaRetainedStrands;
+        m_hairLodSavedBytes += deltaSavedBytes;
+    }
+
+    void UpdateInstanceTransformStats(size_t numUpdated, size_t numSkipped) {
+        m_numUpdatedInstanceTransforms += numUpdated;
+        m_numSkippedInstanceTransforms += numSkipped;
+    }
+
+    void UpdateResidentGeometryBytes(TfToken const& primType, int64_t deltaBytes) {
+        if (primType == HdPrimTypeTokens->mesh) {
+            m_residentMeshBytes += deltaBytes;
+        } else if (primType == HdPrimTypeTokens->basisCurves) {
+            m_residentCurvesBytes += deltaBytes;
+        } else if (primType == HdPrimTypeTokens->points) {
+            m_residentPointsBytes += deltaBytes;
+        } else {
+            TF_CODING_ERROR("Unexpected rprim type: %s", primType.GetText());
+        }
+    }
+
     bool IsSphereAndDiskLightSupported() const {
         return m_rprContextMetadata.pluginType == kPluginNorthstar || m_rprContextMetadata.pluginType == kPluginHybridPro;
     }
@@ -3948,72 +4954,6 @@ private:
         return image;
     }
 
-    void SplitPolygons(const VtIntArray& indexes, const VtIntArray& vpf, VtIntArray& out_newIndexes, VtIntArray& out_newVpf) {
-        out_newIndexes.clear();
-        out_newVpf.clear();
-
-        out_newIndexes.reserve(indexes.size());
-        out_newVpf.reserve(vpf.size());
-
-        VtIntArray::const_iterator idxIt = indexes.begin();
-        for (const int vCount : vpf) {
-            if (vCount == 3 || vCount == 4) {
-                for (int i = 0; i < vCount; ++i) {
-                    out_newIndexes.push_back(*idxIt);
-                    ++idxIt;
-                }
-                out_newVpf.push_back(vCount);
-            } else {
-                const int commonVertex = *idxIt;
-                constexpr int triangleVertexCount = 3;
-                for (int i = 1; i < vCount - 1; ++i) {
-                    out_newIndexes.push_back(commonVertex);
-                    out_newIndexes.push_back(*(idxIt + i + 0));
-                    out_newIndexes.push_back(*(idxIt + i + 1));
-                    out_newVpf.push_back(triangleVertexCount);
-                }
-                idxIt += vCount;
-            }
-        }
-    }
-
-    void SplitPolygons(const VtIntArray& indexes, const VtIntArray& vpf, VtIntArray& out_newIndexes) {
-        out_newIndexes.clear();
-        out_newIndexes.reserve(indexes.size());
-
-        VtIntArray::const_iterator idxIt = indexes.begin();
-        for (const int vCount : vpf) {
-            if (vCount == 3 || vCount == 4) {
-                for (int i = 0; i < vCount; ++i) {
-                    out_newIndexes.push_back(*idxIt);
-                    ++idxIt;
-                }
-            } else {
-                const int commonVertex = *idxIt;
-                for (int i = 1; i < vCount - 1; ++i) {
-                    out_newIndexes.push_back(commonVertex);
-                    out_newIndexes.push_back(*(idxIt + i + 0));
-                    out_newIndexes.push_back(*(idxIt + i + 1));
-                }
-                idxIt += vCount;
-            }
-        }
-    }
-
-    void ConvertIndices(VtIntArray* indices, VtIntArray const& vpf, TfToken const& windingOrder) {
-        if (windingOrder == HdTokens->rightHanded) {
-            return;
-        }
-
-        // XXX: RPR does not allow to select which winding order we want to use and it's by default right handed
-        size_t indicesOffset = 0;
-        for (int iFace = 0; iFace < vpf.size(); ++iFace) {
-            auto faceIndices = indices->data() + indicesOffset;
-            std::swap(faceIndices[0], faceIndices[2]);
-            indicesOffset += vpf[iFace];
-        }
-    }
-
     rpr::Shape* CreateCubeMesh(float width, float height, float depth) {
         constexpr const size_t cubeVertexCount = 24;
         constexpr const size_t cubeNormalCount = 24;
@@ -4608,6 +5548,42 @@ private:
     bool m_isAlphaEnabled;
 
     std::atomic<int> m_numLights{0};
+
+    std::atomic<bool> m_isMeshDeduplicationEnabled{false};
+    std::atomic<bool> m_isCpuGeometryReleaseEnabled{false};
+    std::atomic<bool> m_isCpuSubdivisionEnabled{false};
+    std::atomic<bool> m_isAdaptiveSubdivisionEnabled{false};
+    std::atomic<bool> m_isHairLodEnabled{false};
+    std::atomic<float> m_hairLodStrandsPerPixel{4.0f};
+    std::atomic<uint32_t> m_geometrySettingsVersion{0};
+    std::atomic<int> m_volumeGridCacheBudgetMb{4096};
+    std::atomic<int> m_volumeVoxelBudgetMillions{0};
+    std::atomic<int> m_volumePrefetchFrames{0};
+
+    std::atomic<int64_t> m_residentMeshBytes{0};
+    std::atomic<int64_t> m_residentCurvesBytes{0};
+    std::atomic<int64_t> m_residentPointsBytes{0};
+    std::atomic<int64_t> m_numRefinedTriangles{0};
+    std::atomic<size_t> m_numUpdatedInstanceTransforms{0};
+    std::atomic<size_t> m_numSkippedInstanceTransforms{0};
+    std::atomic<int64_t> m_numRetainedHairStrands{0};
+    std::atomic<int64_t> m_hairLodSavedBytes{0};
+    float m_framesPerSecond = 24.0f;
+    mutable std::mutex m_meshPrototypesMutex;
+    std::map<MeshContentHash, MeshPrototype> m_meshPrototypes;
+    std::unordered_map<rpr::Shape*, MeshContentHash> m_deduplicatedMeshes;
+
+    struct PooledMaterial {
+        RprUsdMaterial* material;
+        size_t numUsers;
+    };
+    mutable std::mutex m_materialPoolMutex;
+    std::map<PooledMaterialKey, PooledMaterial> m_materialPool;
+    std::unordered_map<RprUsdMaterial const*, PooledMaterialKey> m_pooledMaterials;
+    std::atomic<size_t> m_numMaterialPoolHits{0};
+    std::atomic<size_t> m_numMaterialPoolMisses{0};
+
+    StagingMemoryPool m_stagingMemoryPool;
     HdRprApiEnvironmentLight* m_defaultLightObject = nullptr;
 
     bool m_isUniformSeed = true;
@@ -4681,14 +5657,19 @@ HdRprApi::~HdRprApi() {
     delete m_impl;
 }
 
-rpr::Shape* HdRprApi::CreateMesh(VtArray<VtVec3fArray> const& pointSamples, VtIntArray const& pointIndexes, VtArray<VtVec3fArray> const& normalSamples, VtIntArray const& normalIndexes, VtArray<VtVec2fArray> const& uvSamples, VtIntArray const& uvIndexes, VtIntArray const& vpf, TfToken const& polygonWinding) {
+rpr::Shape* HdRprApi::CreateMesh(VtArray<VtVec3fArray> const& pointSamples, VtIntArray const& pointIndexes, VtArray<VtVec3fArray> const& normalSamples, VtIntArray const& normalIndexes, VtArray<VtVec2fArray> const& uvSamples, VtIntArray const& uvIndexes, VtIntArray const& vpf, TfToken const& polygonWinding, HdRprApiMeshTopology* topology, HdRprApiMeshDataState const& dataState) {
+    m_impl->InitIfNeeded();
+    return m_impl->CreateMesh(pointSamples, pointIndexes, normalSamples, normalIndexes, uvSamples, uvIndexes, vpf, polygonWinding, topology, dataState);
+}
+
+rpr::Shape* HdRprApi::CreateMesh(VtVec3fArray const& points, VtIntArray const& pointIndexes, VtVec3fArray const& normals, VtIntArray const& normalIndexes, VtVec2fArray const& uvs, VtIntArray const& uvIndexes, VtIntArray const& vpf, TfToken const& polygonWinding, HdRprApiMeshDataState const& dataState) {
     m_impl->InitIfNeeded();
-    return m_impl->CreateMesh(pointSamples, pointIndexes, normalSamples, normalIndexes, uvSamples, uvIndexes, vpf, polygonWinding);
+    return m_impl->CreateMesh(points, pointIndexes, normals, normalIndexes, uvs, uvIndexes, vpf, polygonWinding, dataState);
 }
 
-rpr::Shape* HdRprApi::CreateMesh(VtVec3fArray const& points, VtIntArray const& pointIndexes, VtVec3fArray const& normals, VtIntArray const& normalIndexes, VtVec2fArray const& uvs, VtIntArray const& uvIndexes, VtIntArray const& vpf, TfToken const& polygonWinding) {
+rpr::Shape* HdRprApi::CreateLightMesh(VtVec3fArray const& points, VtIntArray const& pointIndexes, VtVec3fArray const& normals, VtIntArray const& normalIndexes, VtIntArray const& vpf, TfToken const& polygonWinding) {
     m_impl->InitIfNeeded();
-    return m_impl->CreateMesh(points, pointIndexes, normals, normalIndexes, uvs, uvIndexes, vpf, polygonWinding);
+    return m_impl->CreateLightMesh(points, pointIndexes, normals, normalIndexes, vpf, polygonWinding);
 }
 
 rpr::Curve* HdRprApi::CreateCurve(VtVec3fArray const& points, VtIntArray const& indices, VtFloatArray const& radiuses, VtVec2fArray const& uvs, VtIntArray const& segmentPerCurve) {
@@ -4700,6 +5681,10 @@ rpr::Shape* HdRprApi::CreateMeshInstance(rpr::Shape* prototypeMesh) {
     return m_impl->CreateMeshInstance(prototypeMesh);
 }
 
+std::vector<rpr::Shape*> HdRprApi::CreateMeshInstances(rpr::Shape* prototypeMesh, size_t numInstances) {
+    return m_impl->CreateMeshInstances(prototypeMesh, numInstances);
+}
+
 HdRprApiEnvironmentLight* HdRprApi::CreateEnvironmentLight(GfVec3f color, float intensity, BackgroundOverride const& backgroundOverride) {
     m_impl->InitIfNeeded();
     return m_impl->CreateEnvironmentLight(color, intensity, backgroundOverride);
@@ -4718,10 +5703,14 @@ void HdRprApi::SetTransform(rpr::SceneObject* object, GfMatrix4f const& transfor
     m_impl->SetTransform(object, transform);
 }
 
-void HdRprApi::SetTransform(rpr::Shape* shape, size_t numSamples, float* timeSamples, GfMatrix4d* transformSamples) {
+void HdRprApi::SetTransform(rpr::Shape* shape, size_t numSamples, float const* timeSamples, GfMatrix4d const* transformSamples) {
     m_impl->SetTransform(shape, numSamples, timeSamples, transformSamples);
 }
 
+void HdRprApi::SetTransforms(rpr::Shape* const* shapes, size_t numShapes, size_t numSamples, float const* timeSamples, GfMatrix4d const* transformSamples) {
+    m_impl->SetTransforms(shapes, numShapes, numSamples, timeSamples, transformSamples);
+}
+
 void HdRprApi::SetTransform(HdRprApiVolume* volume, GfMatrix4f const& transform) {
     m_impl->SetTransform(volume, transform);
 }
@@ -4785,15 +5774,15 @@ void HdRprApi::ReleaseGeometryLightMaterial(RprUsdMaterial* material) {
 }
 
 HdRprApiVolume* HdRprApi::CreateVolume(
-    VtUIntArray const& densityCoords, VtFloatArray const& densityValues, VtVec3fArray const& densityLUT, float densityScale,
-    VtUIntArray const& albedoCoords, VtFloatArray const& albedoValues, VtVec3fArray const& albedoLUT, float albedoScale,
-    VtUIntArray const& emissionCoords, VtFloatArray const& emissionValues, VtVec3fArray const& emissionLUT, float emissionScale,
+    HdRprApiVolumeGridIndices const& densityIndices, VtFloatArray* densityValues, VtVec3fArray const& densityLUT, float densityScale,
+    HdRprApiVolumeGridIndices const& albedoIndices, VtFloatArray const& albedoValues, VtVec3fArray const& albedoLUT, float albedoScale,
+    HdRprApiVolumeGridIndices const& emissionIndices, VtFloatArray const& emissionValues, VtVec3fArray const& emissionLUT, float emissionScale,
     const GfVec3i& gridSize, const GfVec3f& voxelSize, const GfVec3f& gridBBLow) {
     m_impl->InitIfNeeded();
     return m_impl->CreateVolume(
-        densityCoords, densityValues, densityLUT, densityScale,
-        albedoCoords, albedoValues, albedoLUT, albedoScale,
-        emissionCoords, emissionValues, emissionLUT, emissionScale,
+        densityIndices, densityValues, densityLUT, densityScale,
+        albedoIndices, albedoValues, albedoLUT, albedoScale,
+        emissionIndices, emissionValues, emissionLUT, emissionScale,
         gridSize, voxelSize, gridBBLow);
 }
 
@@ -4814,10 +5803,7 @@ RprUsdMaterial* HdRprApi::CreatePointsMaterial(VtVec3fArray const& colors) {
 
 RprUsdMaterial* HdRprApi::CreateDiffuseMaterial(GfVec3f const& color) {
     m_impl->InitIfNeeded();
-
-    return m_impl->CreateRawMaterial(RPR_MATERIAL_NODE_UBERV2, {
-        {RPR_MATERIAL_INPUT_UBER_DIFFUSE_COLOR, ToVec4(color, 1.0f)}
-    });
+    return m_impl->CreateDiffuseMaterial(color);
 }
 
 RprUsdMaterial* HdRprApi::CreatePrimvarColorLookupMaterial(){
@@ -4841,10 +5827,18 @@ void HdRprApi::SetMeshVisibility(rpr::Shape* mesh, uint32_t visibilityMask) {
     m_impl->SetMeshVisibility(mesh, visibilityMask);
 }
 
+void HdRprApi::SetMeshVisibility(rpr::Shape* const* meshes, size_t numMeshes, uint32_t visibilityMask) {
+    m_impl->SetMeshVisibility(meshes, numMeshes, visibilityMask);
+}
+
 void HdRprApi::SetMeshId(rpr::Shape* mesh, uint32_t id) {
     m_impl->SetMeshId(mesh, id);
 }
 
+void HdRprApi::SetMeshIds(rpr::Shape* const* meshes, size_t numMeshes, uint32_t firstId) {
+    m_impl->SetMeshIds(meshes, numMeshes, firstId);
+}
+
 void HdRprApi::SetMeshIgnoreContour(rpr::Shape* mesh, bool ignoreContour) {
     m_impl->SetMeshIgnoreContour(mesh, ignoreContour);
 }
@@ -4905,6 +5899,15 @@ HdCamera const* HdRprApi::GetCamera() const {
     return m_impl->GetCamera();
 }
 
+double HdRprApi::GetProjectedSize(GfBBox3d const& bbox) const {
+    return m_impl->GetProjectedSize(bbox);
+}
+
+bool HdRprApi::GetDeformationSampleTimes(size_t numSamples, float* sampleTimes) const {
+    m_impl->InitIfNeeded();
+    return m_impl->GetDeformationSampleTimes(numSamples, sampleTimes);
+}
+
 GfMatrix4d HdRprApi::GetCameraViewMatrix() const {
     return m_impl->GetCameraViewMatrix();
 }
@@ -4950,6 +5953,10 @@ bool HdRprApi::IsChanged() const {
     return m_impl->IsChanged();
 }
 
+uint32_t HdRprApi::GetGeometrySettingsVersion() const {
+    return m_impl->GetGeometrySettingsVersion();
+}
+
 HdRprApi::RenderStats HdRprApi::GetRenderStats() const {
     return m_impl->GetRenderStats();
 }
@@ -4962,6 +5969,67 @@ bool HdRprApi::IsVulkanInteropEnabled() const {
     return m_impl->IsVulkanInteropEnabled();
 }
 
+bool HdRprApi::IsMeshDeduplicationEnabled() const {
+    m_impl->InitIfNeeded();
+    return m_impl->IsMeshDeduplicationEnabled();
+}
+
+bool HdRprApi::IsCpuGeometryReleaseEnabled() const {
+    m_impl->InitIfNeeded();
+    return m_impl->IsCpuGeometryReleaseEnabled();
+}
+
+bool HdRprApi::IsCpuSubdivisionEnabled() const {
+    m_impl->InitIfNeeded();
+    return m_impl->IsCpuSubdivisionEnabled();
+}
+
+bool HdRprApi::IsAdaptiveSubdivisionEnabled() const {
+    m_impl->InitIfNeeded();
+    return m_impl->IsAdaptiveSubdivisionEnabled();
+}
+
+bool HdRprApi::IsHairLodEnabled() const {
+    m_impl->InitIfNeeded();
+    return m_impl->IsHairLodEnabled();
+}
+
+float HdRprApi::GetHairLodStrandsPerPixel() const {
+    m_impl->InitIfNeeded();
+    return m_impl->GetHairLodStrandsPerPixel();
+}
+
+int HdRprApi::GetVolumeGridCacheBudgetMb() const {
+    m_impl->InitIfNeeded();
+    return m_impl->GetVolumeGridCacheBudgetMb();
+}
+
+size_t HdRprApi::GetVolumeVoxelBudget() const {
+    m_impl->InitIfNeeded();
+    return m_impl->GetVolumeVoxelBudget();
+}
+
+int HdRprApi::GetVolumePrefetchFrames() const {
+    m_impl->InitIfNeeded();
+    return m_impl->GetVolumePrefetchFrames();
+}
+
+void HdRprApi::UpdateRefinedTriangleCount(int64_t deltaTriangles) {
+    m_impl->UpdateRefinedTriangleCount(deltaTriangles);
+}
+
+void HdRprApi::UpdateHairLodStats(int64_t deltaRetainedStrands, int64_t deltaSavedBytes) {
+    m_impl->UpdateHairLodStats(deltaRetainedStrands, deltaSavedBytes);
+}
+
+void HdRprApi::UpdateInstanceTransformStats(size_t numUpdated, size_t numSkipped) {
+    m_impl->UpdateInstanceTransformStats(numUpdated, numSkipped);
+}
+
+void HdRprApi::UpdateResidentGeometryBytes(TfToken const& primType, int64_t deltaBytes) {
+    m_impl->UpdateResidentGeometryBytes(primType, deltaBytes);
+}
+
 bool HdRprApi::IsArbitraryShapedLightSupported() const {
     m_impl->InitIfNeeded();
     return m_impl->IsArbitraryShapedLightSupported();
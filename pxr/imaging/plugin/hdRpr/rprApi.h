@@ -21,6 +21,7 @@ limitations under the License.
 #include "pxr/base/vt/array.h"
 #include "pxr/base/gf/matrix4f.h"
 #include "pxr/base/gf/quaternion.h"
+#include "pxr/base/gf/bbox3d.h"
 #include "pxr/base/tf/staticTokens.h"
 #include "pxr/imaging/hd/types.h"
 #include "pxr/imaging/hd/camera.h"
@@ -52,6 +53,51 @@ class RprUsdMaterial;
 struct HdRprApiVolume;
 struct HdRprApiEnvironmentLight;
 
+// Mesh index buffers converted to the RPR layout (polygons split into triangles and quads, right-handed winding).
+// Passing the same object to the subsequent CreateMesh calls of a mesh allows to skip
+// the topology conversion and hashing when only the vertex data has changed
+struct HdRprApiMeshTopology {
+    VtIntArray pointIndices;
+    VtIntArray normalIndices;
+    VtIntArray uvIndices;
+    VtIntArray vpf;
+    TfToken polygonWinding;
+
+    // Hash of the index buffers above, computed on demand by the mesh deduplication
+    bool hasContentHash = false;
+    uint64_t contentHash[2] = {0, 0};
+    size_t contentNumBytes = 0;
+
+    // Index streams the buffers below were converted for
+    bool isConverted = false;
+    uint32_t indexStreams = 0;
+    VtIntArray rprPointIndices;
+    VtIntArray rprNormalIndices;
+    VtIntArray rprUvIndices;
+    VtIntArray rprVpf;
+};
+
+// Subdivision settings and vertex colors are stored in the RPR mesh data rather than in the shape.
+// Deduplicated meshes share the data only when this state is equal as well, so it has to be passed
+// on mesh creation and a mesh has to be recreated to change it. Set* calls on the created mesh must match it
+struct HdRprApiMeshDataState {
+    int refineLevel = 0;
+    float creaseWeight = 0.0f;
+    TfToken boundaryInterpolation;
+    VtArray<VtVec3fArray> colorSamples;
+    HdInterpolation colorInterpolation = HdInterpolationConstant;
+};
+
+// Active voxels of a volume grid addressed by linear indices: x + y * gridSize[0] + z * gridSize[0] * gridSize[1].
+// 32-bit indices are used when they can address every voxel of the grid
+struct HdRprApiVolumeGridIndices {
+    VtUIntArray indices32;
+    VtUInt64Array indices64;
+
+    size_t size() const { return indices64.empty() ? indices32.size() : indices64.size(); }
+    bool empty() const { return size() == 0; }
+};
+
 template <typename T, typename... Args>
 std::unique_ptr<T> make_unique(Args&&... args) {
     return std::unique_ptr<T>(new T(std::forward<Args>(args)...));
@@ -107,9 +153,10 @@ public:
     RprUsdMaterial* CreateGeometryLightMaterial(GfVec3f const& emissionColor);
     void ReleaseGeometryLightMaterial(RprUsdMaterial* material);
 
-    HdRprApiVolume* CreateVolume(VtUIntArray const& densityCoords, VtFloatArray const& densityValues, VtVec3fArray const& densityLUT, float densityScale,
-                                 VtUIntArray const& albedoCoords, VtFloatArray const& albedoValues, VtVec3fArray const& albedoLUT, float albedoScale,
-                                 VtUIntArray const& emissionCoords, VtFloatArray const& emissionValues, VtVec3fArray const& emissionLUT, float emissionScale,
+    // Density values are remapped through the density lookup table in-place
+    HdRprApiVolume* CreateVolume(HdRprApiVolumeGridIndices const& densityIndices, VtFloatArray* densityValues, VtVec3fArray const& densityLUT, float densityScale,
+                                 HdRprApiVolumeGridIndices const& albedoIndices, VtFloatArray const& albedoValues, VtVec3fArray const& albedoLUT, float albedoScale,
+                                 HdRprApiVolumeGridIndices const& emissionIndices, VtFloatArray const& emissionValues, VtVec3fArray const& emissionLUT, float emissionScale,
                                  const GfVec3i& gridSize, const GfVec3f& voxelSize, const GfVec3f& gridBBLow);
     void SetTransform(HdRprApiVolume* volume, GfMatrix4f const& transform);
     void SetVolumeVisibility(HdRprApiVolume* volume, uint32_t visibilityMask);
@@ -117,18 +164,27 @@ public:
 
     RprUsdMaterial* CreateMaterial(SdfPath const& materialId, HdSceneDelegate* sceneDelegate, HdMaterialNetworkMap const& materialNetwork);
     RprUsdMaterial* CreatePointsMaterial(VtVec3fArray const& colors);
+    // Diffuse, geometry light and primvar color lookup materials are pooled: requests with the same parameters
+    // return the same refcounted material, every returned material should be released once
     RprUsdMaterial* CreateDiffuseMaterial(GfVec3f const& color);
     RprUsdMaterial* CreatePrimvarColorLookupMaterial();
     void Release(RprUsdMaterial* material);
 
-    rpr::Shape* CreateMesh(VtVec3fArray const& points, VtIntArray const& pointIndexes, VtVec3fArray const& normals, VtIntArray const& normalIndexes, VtVec2fArray const& uvs, VtIntArray const& uvIndexes, VtIntArray const& vpf, TfToken const& polygonWinding);
-    rpr::Shape* CreateMesh(VtArray<VtVec3fArray> const& pointSamples, VtIntArray const& pointIndexes, VtArray<VtVec3fArray> const& normalSamples, VtIntArray const& normalIndexes, VtArray<VtVec2fArray> const& uvSamples, VtIntArray const& uvIndexes, VtIntArray const& vpf, TfToken const& polygonWinding);
+    rpr::Shape* CreateMesh(VtVec3fArray const& points, VtIntArray const& pointIndexes, VtVec3fArray const& normals, VtIntArray const& normalIndexes, VtVec2fArray const& uvs, VtIntArray const& uvIndexes, VtIntArray const& vpf, TfToken const& polygonWinding, HdRprApiMeshDataState const& dataState = HdRprApiMeshDataState());
+    rpr::Shape* CreateMesh(VtArray<VtVec3fArray> const& pointSamples, VtIntArray const& pointIndexes, VtArray<VtVec3fArray> const& normalSamples, VtIntArray const& normalIndexes, VtArray<VtVec2fArray> const& uvSamples, VtIntArray const& uvIndexes, VtIntArray const& vpf, TfToken const& polygonWinding, HdRprApiMeshTopology* topology = nullptr, HdRprApiMeshDataState const& dataState = HdRprApiMeshDataState());
+    // Area light meshes of the same shape are instances of a single hidden prototype, so they should be released with Release(rpr::Shape*)
+    rpr::Shape* CreateLightMesh(VtVec3fArray const& points, VtIntArray const& pointIndexes, VtVec3fArray const& normals, VtIntArray const& normalIndexes, VtIntArray const& vpf, TfToken const& polygonWinding);
     rpr::Shape* CreateMeshInstance(rpr::Shape* prototypeMesh);
+    // Batch variants of the instance setup calls. The RPR context is locked once per call rather than once per instance
+    std::vector<rpr::Shape*> CreateMeshInstances(rpr::Shape* prototypeMesh, size_t numInstances);
     void SetMeshRefineLevel(rpr::Shape* mesh, int level, const float creaseWeight);
     void SetMeshVertexInterpolationRule(rpr::Shape* mesh, TfToken boundaryInterpolation);
     void SetMeshMaterial(rpr::Shape* mesh, RprUsdMaterial const* material, bool displacementEnabled);
     void SetMeshVisibility(rpr::Shape* mesh, uint32_t visibilityMask);
+    void SetMeshVisibility(rpr::Shape* const* meshes, size_t numMeshes, uint32_t visibilityMask);
     void SetMeshId(rpr::Shape* mesh, uint32_t id);
+    // Assigns consecutive ids starting from firstId
+    void SetMeshIds(rpr::Shape* const* meshes, size_t numMeshes, uint32_t firstId);
     void SetMeshIgnoreContour(rpr::Shape* mesh, bool ignoreContour);
     bool SetMeshVertexColor(rpr::Shape* mesh, VtArray<VtVec3fArray> const& primvarSamples, HdInterpolation interpolation);
     void Release(rpr::Shape* shape);
@@ -139,7 +195,9 @@ public:
     void Release(rpr::Curve* curve);
 
     void SetTransform(rpr::SceneObject* object, GfMatrix4f const& transform);
-    void SetTransform(rpr::Shape* shape, size_t numSamples, float* timeSamples, GfMatrix4d* transformSamples);
+    void SetTransform(rpr::Shape* shape, size_t numSamples, float const* timeSamples, GfMatrix4d const* transformSamples);
+    // transformSamples holds numSamples consecutive transforms per shape
+    void SetTransforms(rpr::Shape* const* shapes, size_t numShapes, size_t numSamples, float const* timeSamples, GfMatrix4d const* transformSamples);
 
     void SetName(rpr::ContextObject* object, const char* name);
     void SetName(RprUsdMaterial* object, const char* name);
@@ -149,6 +207,12 @@ public:
     const GfMatrix4d& GetCameraProjectionMatrix() const;
 
     HdCamera const* GetCamera() const;
+    // Fills times (in seconds, relative to the current frame) at which deformation motion samples are rendered.
+    // Returns false if deformation motion blur is not rendered
+    bool GetDeformationSampleTimes(size_t numSamples, float* sampleTimes) const;
+    // Returns the fraction of the viewport covered by the bounding box projected with the current camera.
+    // Returns a negative value if there is no camera
+    double GetProjectedSize(GfBBox3d const& bbox) const;
     void SetCamera(HdCamera const* camera);
 
     GfVec2i GetViewportSize() const;
@@ -174,6 +238,23 @@ public:
         double frameResolveTotalTime;
         double cacheCreationTime;
         double syncTime;
+        size_t numDeduplicatedMeshes;
+        size_t deduplicatedMeshBytes;
+        size_t numSharedLightMeshes;
+        size_t peakStagingMemoryBytes;
+        size_t residentMeshBytes;
+        size_t residentCurvesBytes;
+        size_t residentPointsBytes;
+        size_t numRefinedTriangles;
+        // Accumulated over all syncs
+        size_t numUpdatedInstanceTransforms;
+        size_t numSkippedInstanceTransforms;
+        size_t numRetainedHairStrands;
+        size_t hairLodSavedBytes;
+        size_t numPooledMaterials;
+        // Accumulated over all syncs
+        size_t numMaterialPoolHits;
+        size_t numMaterialPoolMisses;
     };
     RenderStats GetRenderStats() const;
 
@@ -181,6 +262,14 @@ public:
     int GetCpuThreadCountUsed() const;
     float GetFirstIterationRenerTime() const;
 
+    // Tracks the size of geometry data kept on the CPU side by rprims of the given type
+    void UpdateResidentGeometryBytes(TfToken const& primType, int64_t deltaBytes);
+    // Tracks the number of triangles meshes have after subdivision
+    void UpdateRefinedTriangleCount(int64_t deltaTriangles);
+    void UpdateInstanceTransformStats(size_t numUpdated, size_t numSkipped);
+    // Tracks the number of curve strands passed to RPR and the size of the curve buffers dropped by hair LOD
+    void UpdateHairLodStats(int64_t deltaRetainedStrands, int64_t deltaSavedBytes);
+
     void CommitResources();
     void Resolve(SdfPath const& aovId);
     void Render(HdRprRenderThread* renderThread);
@@ -190,6 +279,18 @@ public:
     bool IsGlInteropEnabled() const;
     bool IsVulkanInteropEnabled() const;
     bool IsArbitraryShapedLightSupported() const;
+    bool IsMeshDeduplicationEnabled() const;
+    bool IsCpuGeometryReleaseEnabled() const;
+    bool IsCpuSubdivisionEnabled() const;
+    bool IsAdaptiveSubdivisionEnabled() const;
+    bool IsHairLodEnabled() const;
+    float GetHairLodStrandsPerPixel() const;
+    // Incremented when the settings that rprims read on sync are changed, e.g. adaptive subdivision or hair LOD
+    uint32_t GetGeometrySettingsVersion() const;
+    int GetVolumeGridCacheBudgetMb() const;
+    // Maximum number of active voxels of a volume grid, 0 if the grids are not limited
+    size_t GetVolumeVoxelBudget() const;
+    int GetVolumePrefetchFrames() const;
     bool IsSphereAndDiskLightSupported() const;
     TfToken const& GetCurrentRenderQuality() const;
     rpr::FrameBuffer* GetRawColorFramebuffer();
@@ -0,0 +1,230 @@
+/************************************************************************
+Copyright 2020 Advanced Micro Devices, Inc
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+    http://www.apache.org/licenses/LICENSE-2.0
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+************************************************************************/
+
+#include "subdivision.h"
+
+#include "pxr/base/work/loops.h"
+
+#include <opensubdiv/far/topologyRefiner.h>
+#include <opensubdiv/far/primvarRefiner.h>
+
+#include <map>
+#include <mutex>
+
+PXR_NAMESPACE_OPEN_SCOPE
+
+using namespace OpenSubdiv;
+
+namespace {
+
+// Adapts primvar values to the interface OpenSubdiv's PrimvarRefiner works with
+template <typename T>
+struct PrimvarValue {
+    void Clear(void* = nullptr) {
+        value = T(0.0f);
+    }
+
+    void AddWithWeight(PrimvarValue const& src, float weight) {
+        value += src.value * weight;
+    }
+
+    T value;
+};
+
+template <typename T>
+void RefineVertexPrimvar(HdRprRefinedTopology const& topology, T const* baseValues, T* limitValues, T* limitDu = nullptr, T* limitDv = nullptr) {
+    using Value = PrimvarValue<T>;
+    static_assert(sizeof(Value) == sizeof(T), "PrimvarValue must have the same layout as the wrapped type");
+
+    auto const& refiner = *topology.refiner;
+    Far::PrimvarRefiner primvarRefiner(refiner);
+
+    // Values of the intermediate refinement levels, the base level values are read in-place
+    std::vector<Value> levelValues(refiner.GetNumVerticesTotal() - topology.numBaseVertices);
+
+    Value const* src = reinterpret_cast<Value const*>(baseValues);
+    Value* dst = levelValues.data();
+    for (int level = 1; level <= refiner.GetMaxLevel(); ++level) {
+        primvarRefiner.Interpolate(level, src, dst);
+        src = dst;
+        dst += refiner.GetLevel(level).GetNumVertices();
+    }
+
+    Value* limit = reinterpret_cast<Value*>(limitValues);
+    if (limitDu && limitDv) {
+        Value* du = reinterpret_cast<Value*>(limitDu);
+        Value* dv = reinterpret_cast<Value*>(limitDv);
+        primvarRefiner.Limit(src, limit, du, dv);
+    } else {
+        primvarRefiner.Limit(src, limit);
+    }
+}
+
+template <typename T>
+bool RefineVertexPrimvar(HdRprRefinedTopology const& topology, VtArray<T> const& primvar, VtArray<T>* out_primvar) {
+    if (primvar.size() < topology.numBaseVertices) {
+        return false;
+    }
+
+    out_primvar->resize(topology.numRefinedVertices);
+    RefineVertexPrimvar(topology, primvar.cdata(), out_primvar->data());
+    return true;
+}
+
+struct RefinedTopologyCache {
+    std::mutex mutex;
+    std::map<std::pair<PxOsdMeshTopology::ID, int>, std::weak_ptr<HdRprRefinedTopology const>> entries;
+};
+
+RefinedTopologyCache& GetRefinedTopologyCache() {
+    static RefinedTopologyCache cache;
+    return cache;
+}
+
+} // namespace anonymous
+
+HdRprRefinedTopologySharedPtr HdRprGetRefinedTopology(
+    PxOsdMeshTopology const& topology,
+    int refineLevel,
+    SdfPath const& id) {
+    if (refineLevel <= 0) {
+        return nullptr;
+    }
+
+    auto& cache = GetRefinedTopologyCache();
+    auto key = std::make_pair(topology.ComputeHash(), refineLevel);
+
+    auto findCached = [&]() -> HdRprRefinedTopologySharedPtr {
+        auto it = cache.entries.find(key);
+        if (it != cache.entries.end()) {
+            auto entry = it->second.lock();
+            if (entry && entry->baseTopology == topology) {
+                return entry;
+            }
+        }
+        return nullptr;
+    };
+
+    {
+        std::lock_guard<std::mutex> lock(cache.mutex);
+        if (auto entry = findCached()) {
+            return entry;
+        }
+    }
+
+    // Refine outside of the lock so that meshes with different topologies are refined in parallel
+    auto refiner = PxOsdRefinerFactory::Create(topology, id.GetToken());
+    if (!refiner) {
+        TF_RUNTIME_ERROR("[%s] Failed to create topology refiner", id.GetText());
+        return nullptr;
+    }
+
+    Far::TopologyRefiner::UniformOptions options(refineLevel);
+    // Required to evaluate the limit surface
+    options.fullTopologyInLastLevel = true;
+    refiner->RefineUniform(options);
+
+    auto refined = std::make_shared<HdRprRefinedTopology>();
+    refined->baseTopology = topology;
+    refined->refineLevel = refineLevel;
+    refined->refiner = refiner;
+    refined->numBaseVertices = refiner->GetLevel(0).GetNumVertices();
+
+    auto const& lastLevel = refiner->GetLevel(refiner->GetMaxLevel());
+    refined->numRefinedVertices = lastLevel.GetNumVertices();
+
+    size_t numFaces = 0;
+    size_t numIndices = 0;
+    for (int face = 0; face < lastLevel.GetNumFaces(); ++face) {
+        if (!lastLevel.IsFaceHole(face)) {
+            numFaces++;
+            numIndices += lastLevel.GetFaceVertices(face).size();
+        }
+    }
+
+    refined->faceVertexCounts.resize(numFaces);
+    refined->faceVertexIndices.resize(numIndices);
+    auto faceVertexCounts = refined->faceVertexCounts.data();
+    auto faceVertexIndices = refined->faceVertexIndices.data();
+    for (int face = 0; face < lastLevel.GetNumFaces(); ++face) {
+        if (lastLevel.IsFaceHole(face)) {
+            continue;
+        }
+
+        auto faceVertices = lastLevel.GetFaceVertices(face);
+        *faceVertexCounts++ = faceVertices.size();
+        faceVertexIndices = std::copy(faceVertices.begin(), faceVertices.end(), faceVertexIndices);
+    }
+
+    std::lock_guard<std::mutex> lock(cache.mutex);
+    if (auto entry = findCached()) {
+        // Refined concurrently by another mesh
+        return entry;
+    }
+
+    // Drop the entries of topologies that are no longer used by any mesh
+    for (auto it = cache.entries.begin(); it != cache.entries.end();) {
+        if (it->second.expired()) {
+            it = cache.entries.erase(it);
+        } else {
+            ++it;
+        }
+    }
+
+    cache.entries[key] = refined;
+    return refined;
+}
+
+bool HdRprRefinePoints(
+    HdRprRefinedTopology const& topology,
+    VtVec3fArray const& points,
+    VtVec3fArray* out_points,
+    VtVec3fArray* out_normals) {
+    if (points.size() < topology.numBaseVertices) {
+        return false;
+    }
+
+    out_points->resize(topology.numRefinedVertices);
+    std::vector<GfVec3f> du(topology.numRefinedVertices);
+    std::vector<GfVec3f> dv(topology.numRefinedVertices);
+    RefineVertexPrimvar(topology, points.cdata(), out_points->data(), du.data(), dv.data());
+
+    out_normals->resize(topology.numRefinedVertices);
+    GfVec3f* normals = out_normals->data();
+    WorkParallelForN(topology.numRefinedVertices,
+        [&](size_t begin, size_t end) {
+            for (size_t i = begin; i < end; ++i) {
+                normals[i] = GfCross(du[i], dv[i]);
+                normals[i].Normalize();
+            }
+        }
+    );
+
+    return true;
+}
+
+bool HdRprRefineVertexPrimvar(
+    HdRprRefinedTopology const& topology,
+    VtVec3fArray const& primvar,
+    VtVec3fArray* out_primvar) {
+    return RefineVertexPrimvar(topology, primvar, out_primvar);
+}
+
+bool HdRprRefineVertexPrimvar(
+    HdRprRefinedTopology const& topology,
+    VtVec2fArray const& primvar,
+    VtVec2fArray* out_primvar) {
+    return RefineVertexPrimvar(topology, primvar, out_primvar);
+}
+
+PXR_NAMESPACE_CLOSE_SCOPE
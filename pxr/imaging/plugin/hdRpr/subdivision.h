@@ -0,0 +1,69 @@
+/************************************************************************
+Copyright 2020 Advanced Micro Devices, Inc
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+    http://www.apache.org/licenses/LICENSE-2.0
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+************************************************************************/
+
+#ifndef HDRPR_SUBDIVISION_H
+#define HDRPR_SUBDIVISION_H
+
+#include "pxr/imaging/pxOsd/meshTopology.h"
+#include "pxr/imaging/pxOsd/refinerFactory.h"
+#include "pxr/usd/sdf/path.h"
+#include "pxr/base/vt/array.h"
+#include "pxr/base/gf/vec2f.h"
+#include "pxr/base/gf/vec3f.h"
+
+#include <memory>
+
+PXR_NAMESPACE_OPEN_SCOPE
+
+// Uniformly refined mesh topology. It's shared between all meshes with the same base topology and refine level
+struct HdRprRefinedTopology {
+    PxOsdMeshTopology baseTopology;
+    int refineLevel;
+
+    PxOsdTopologyRefinerSharedPtr refiner;
+    size_t numBaseVertices;
+    size_t numRefinedVertices;
+
+    // Faces of the last refinement level, holes are excluded
+    VtIntArray faceVertexCounts;
+    VtIntArray faceVertexIndices;
+};
+using HdRprRefinedTopologySharedPtr = std::shared_ptr<HdRprRefinedTopology const>;
+
+// Returns refined topology from the process-wide cache, the topology is refined if it's not cached yet.
+// Returns nullptr if the topology could not be refined
+HdRprRefinedTopologySharedPtr HdRprGetRefinedTopology(
+    PxOsdMeshTopology const& topology,
+    int refineLevel,
+    SdfPath const& id);
+
+// Evaluates limit positions and normals of the refined surface
+bool HdRprRefinePoints(
+    HdRprRefinedTopology const& topology,
+    VtVec3fArray const& points,
+    VtVec3fArray* out_points,
+    VtVec3fArray* out_normals);
+
+// Evaluates vertex interpolated primvar at the limit surface
+bool HdRprRefineVertexPrimvar(
+    HdRprRefinedTopology const& topology,
+    VtVec3fArray const& primvar,
+    VtVec3fArray* out_primvar);
+bool HdRprRefineVertexPrimvar(
+    HdRprRefinedTopology const& topology,
+    VtVec2fArray const& primvar,
+    VtVec2fArray* out_primvar);
+
+PXR_NAMESPACE_CLOSE_SCOPE
+
+#endif // HDRPR_SUBDIVISION_H
@@ -0,0 +1,425 @@
+/************************************************************************
+Copyright 2020 Advanced Micro Devices, Inc
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+    http://www.apache.org/licenses/LICENSE-2.0
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+************************************************************************/
+
+#include "vdbGridCache.h"
+
+#include "pxr/base/arch/fileSystem.h"
+#include "pxr/base/tf/diagnostic.h"
+
+#include <algorithm>
+#include <cfloat>
+#include <list>
+#include <map>
+#include <tuple>
+
+PXR_NAMESPACE_OPEN_SCOPE
+
+namespace {
+
+// File path, grid name, file modification time and voxel size scale of the resampled grids (1 for the grids read from the file)
+using GridKey = std::tuple<std::string, std::string, double, double>;
+// File path and grid name
+using GridId = std::pair<std::string, std::string>;
+
+struct GridEntry {
+    // Serializes reading of the grid so that volumes referencing the same grid read it once
+    std::mutex loadMutex;
+    HdRprVdbGridSharedPtr grid;
+    size_t numBytes = 0;
+    std::list<GridKey>::iterator lruIt;
+    // Prefetched grids are not evicted until they are requested for the first time or released by the prefetcher.
+    // The pin is tagged with the prefetcher and the field that requested it
+    HdRprVdbGridPrefetcher const* pinOwner = nullptr;
+    SdfPath pinFieldId;
+};
+
+struct VdbGridCache {
+    std::mutex mutex;
+    std::map<GridKey, std::shared_ptr<GridEntry>> entries;
+    // Most recently used grids are at the front
+    std::list<GridKey> lru;
+    size_t budget = size_t(4096) << 20;
+    size_t numBytes = 0;
+    size_t numPinnedBytes = 0;
+    size_t numHits = 0;
+    size_t numMisses = 0;
+
+    void Erase(std::map<GridKey, std::shared_ptr<GridEntry>>::iterator it) {
+        Unpin(it->second.get());
+        numBytes -= it->second->numBytes;
+        lru.erase(it->second->lruIt);
+        entries.erase(it);
+    }
+
+    void Pin(GridEntry* entry, HdRprVdbGridPrefetcher const* owner, SdfPath const& fieldId) {
+        if (!entry->pinOwner) {
+            numPinnedBytes += entry->numBytes;
+        }
+        entry->pinOwner = owner;
+        entry->pinFieldId = fieldId;
+    }
+
+    void Unpin(GridEntry* entry) {
+        if (entry->pinOwner) {
+            entry->pinOwner = nullptr;
+            entry->pinFieldId = SdfPath();
+            numPinnedBytes -= entry->numBytes;
+        }
+    }
+
+    void EvictOverBudget(GridEntry const* keep) {
+        auto lruIt = lru.end();
+        while (numBytes > budget && lruIt != lru.begin()) {
+            auto it = entries.find(*(--lruIt));
+            // Grids that are being read are not accounted yet
+            if (it->second.get() == keep || it->second->numBytes == 0 || it->second->pinOwner) {
+                continue;
+            }
+
+            ++lruIt;
+            Erase(it);
+        }
+    }
+};
+
+VdbGridCache& GetVdbGridCache() {
+    // Intentionally leaked, render delegates that prefetch grids may be destroyed after static objects
+    static auto cache = new VdbGridCache;
+    return *cache;
+}
+
+double GetModificationTime(std::string const& path) {
+    double modificationTime = 0.0;
+    ArchGetModificationTime(path.c_str(), &modificationTime);
+    return modificationTime;
+}
+
+HdRprVdbGridSharedPtr ReadVdbGrid(std::string const& filepath, std::string const& gridName, SdfPath const& id) {
+    openvdb::initialize();
+
+    try {
+        openvdb::io::File file(filepath);
+        file.open();
+
+        auto grid = std::make_shared<HdRprVdbGrid>();
+        grid->fileMetadata = file.getMetadata();
+        grid->grid = file.readGrid(gridName);
+        return grid;
+    } catch (openvdb::Exception const& e) {
+        TF_RUNTIME_ERROR("[%s] Failed to read vdb grid from file \"%s\": %s", id.GetText(), filepath.c_str(), e.what());
+    }
+
+    return nullptr;
+}
+
+bool CanPrefetchVdbGrid(std::string const& filepath, std::string const& gridName) {
+    auto& cache = GetVdbGridCache();
+    auto key = GridKey(filepath, gridName, GetModificationTime(filepath), 1.0);
+
+    std::lock_guard<std::mutex> lock(cache.mutex);
+    // Grids that are prefetched while the cache is filled with the unused ones would be never evicted
+    return cache.entries.count(key) == 0 && cache.numPinnedBytes < cache.budget;
+}
+
+// Unpins the grids prefetched by the owner for the field, or for all fields if fieldId is empty, except the kept ones
+void UnpinVdbGrids(
+    HdRprVdbGridPrefetcher const* owner,
+    SdfPath const& fieldId,
+    std::set<GridId> const& keep) {
+    auto& cache = GetVdbGridCache();
+    std::lock_guard<std::mutex> lock(cache.mutex);
+    if (cache.numPinnedBytes == 0) {
+        return;
+    }
+
+    for (auto& entry : cache.entries) {
+        auto& gridEntry = entry.second;
+        if (gridEntry->pinOwner == owner &&
+            (fieldId.IsEmpty() || gridEntry->pinFieldId == fieldId) &&
+            !keep.count(GridId(std::get<0>(entry.first), std::get<1>(entry.first)))) {
+            cache.Unpin(gridEntry.get());
+        }
+    }
+    cache.EvictOverBudget(nullptr);
+}
+
+HdRprVdbGridSharedPtr GetVdbGrid(
+    std::string const& filepath,
+    std::string const& gridName,
+    SdfPath const& id,
+    double voxelSizeScale,
+    HdRprVdbGridResampler const* resample,
+    HdRprVdbGridPrefetcher const* prefetcher,
+    SdfPath const& prefetchFieldId);
+
+HdRprVdbGridSharedPtr ResampleVdbGrid(
+    std::string const& filepath,
+    std::string const& gridName,
+    SdfPath const& id,
+    double voxelSizeScale,
+    HdRprVdbGridResampler const& resample) {
+    auto sourceGrid = GetVdbGrid(filepath, gridName, id, 1.0, nullptr, nullptr, SdfPath());
+    if (!sourceGrid) {
+        return nullptr;
+    }
+
+    auto resampledGrid = resample(*sourceGrid->grid, voxelSizeScale);
+    if (!resampledGrid) {
+        return nullptr;
+    }
+
+    auto grid = std::make_shared<HdRprVdbGrid>();
+    grid->grid = resampledGrid;
+    grid->fileMetadata = sourceGrid->fileMetadata;
+    return grid;
+}
+
+// Grids read for the prefetcher are pinned until they are requested with a null prefetcher or unpinned
+HdRprVdbGridSharedPtr GetVdbGrid(
+    std::string const& filepath,
+    std::string const& gridName,
+    SdfPath const& id,
+    double voxelSizeScale,
+    HdRprVdbGridResampler const* resample,
+    HdRprVdbGridPrefetcher const* prefetcher,
+    SdfPath const& prefetchFieldId) {
+    auto& cache = GetVdbGridCache();
+    auto modificationTime = GetModificationTime(filepath);
+    auto key = GridKey(filepath, gridName, modificationTime, voxelSizeScale);
+
+    std::shared_ptr<GridEntry> entry;
+    {
+        std::lock_guard<std::mutex> lock(cache.mutex);
+        auto it = cache.entries.find(key);
+        if (it != cache.entries.end()) {
+            entry = it->second;
+            cache.lru.splice(cache.lru.begin(), cache.lru, entry->lruIt);
+        } else {
+            // Grids of the previous versions of the file are not going to be requested anymore
+            auto staleIt = cache.entries.lower_bound(GridKey(filepath, gridName, -DBL_MAX, -DBL_MAX));
+            while (staleIt != cache.entries.end() &&
+                   std::get<0>(staleIt->first) == filepath &&
+                   std::get<1>(staleIt->first) == gridName) {
+                if (std::get<2>(staleIt->first) != modificationTime) {
+                    cache.Erase(staleIt++);
+                } else {
+                    ++staleIt;
+                }
+            }
+
+            entry = std::make_shared<GridEntry>();
+            entry->lruIt = cache.lru.insert(cache.lru.begin(), key);
+            cache.entries.emplace(key, entry);
+        }
+    }
+
+    // Read outside of the cache lock so that different grids are read in parallel
+    std::lock_guard<std::mutex> loadLock(entry->loadMutex);
+    if (entry->grid) {
+        std::lock_guard<std::mutex> lock(cache.mutex);
+        cache.numHits++;
+        if (!prefetcher && entry->pinOwner) {
+            cache.Unpin(entry.get());
+            cache.EvictOverBudget(entry.get());
+        }
+        return entry->grid;
+    }
+
+    auto grid = resample ?
+        ResampleVdbGrid(filepath, gridName, id, voxelSizeScale, *resample) :
+        ReadVdbGrid(filepath, gridName, id);
+
+    std::lock_guard<std::mutex> lock(cache.mutex);
+    cache.numMisses++;
+
+    auto it = cache.entries.find(key);
+    if (it == cache.entries.end() || it->second != entry) {
+        // Dropped from the cache while being read
+        return grid;
+    }
+
+    if (!grid) {
+        // Failures are not cached so that the grid is read again on the next request
+        cache.Erase(it);
+        return nullptr;
+    }
+
+    entry->grid = grid;
+    entry->numBytes = grid->grid->memUsage();
+    cache.numBytes += entry->numBytes;
+    if (prefetcher) {
+        cache.Pin(entry.get(), prefetcher, prefetchFieldId);
+    }
+    cache.EvictOverBudget(entry.get());
+
+    return grid;
+}
+
+} // namespace anonymous
+
+HdRprVdbGridSharedPtr HdRprGetVdbGrid(
+    std::string const& filepath,
+    std::string const& gridName,
+    SdfPath const& id) {
+    return GetVdbGrid(filepath, gridName, id, 1.0, nullptr, nullptr, SdfPath());
+}
+
+HdRprVdbGridSharedPtr HdRprGetResampledVdbGrid(
+    std::string const& filepath,
+    std::string const& gridName,
+    SdfPath const& id,
+    double voxelSizeScale,
+    HdRprVdbGridResampler const& resample) {
+    return GetVdbGrid(filepath, gridName, id, voxelSizeScale, &resample, nullptr, SdfPath());
+}
+
+HdRprVdbGridPrefetcher::~HdRprVdbGridPrefetcher() {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_requests.clear();
+        m_fieldGrids.clear();
+        m_isStopped = true;
+    }
+    m_requestsCV.notify_all();
+
+    // Grids that are being read can't be interrupted, wait for them
+    for (auto& thread : m_threads) {
+        thread.join();
+    }
+
+    UnpinVdbGrids(this, SdfPath(), {});
+}
+
+void HdRprVdbGridPrefetcher::Prefetch(
+    SdfPath const& fieldId,
+    std::string const& gridName,
+    std::vector<std::string> const& filepaths) {
+    // Reading is I/O bound, a couple of threads is enough to stay ahead of the playback
+    static const size_t kNumThreads = 2;
+    // Requests of the frames that were skipped while scrubbing are dropped
+    static const size_t kMaxPendingRequests = 64;
+
+    std::set<GridId> fieldGrids;
+    for (auto& filepath : filepaths) {
+        fieldGrids.emplace(filepath, gridName);
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        auto fieldIt = m_fieldGrids.find(fieldId);
+        if (fieldGrids.empty()) {
+            if (fieldIt == m_fieldGrids.end()) {
+                return;
+            }
+            m_fieldGrids.erase(fieldIt);
+        } else if (fieldIt == m_fieldGrids.end()) {
+            m_fieldGrids.emplace(fieldId, fieldGrids);
+        } else {
+            fieldIt->second = fieldGrids;
+        }
+
+        if (m_threads.empty() && !fieldGrids.empty()) {
+            for (size_t i = 0; i < kNumThreads; ++i) {
+                m_threads.emplace_back([this]() { ProcessRequests(); });
+            }
+        }
+
+        // Frames the field moved past are not read anymore
+        m_requests.erase(std::remove_if(m_requests.begin(), m_requests.end(),
+            [&](Request const& request) {
+                return request.fieldId == fieldId && !fieldGrids.count(GridId(request.filepath, request.gridName));
+            }), m_requests.end());
+
+        for (auto& filepath : filepaths) {
+            auto isPending = std::any_of(m_requests.begin(), m_requests.end(),
+                [&](Request const& request) {
+                    return request.filepath == filepath && request.gridName == gridName;
+                });
+            if (isPending) {
+                continue;
+            }
+
+            if (m_requests.size() >= kMaxPendingRequests) {
+                m_requests.pop_front();
+            }
+            m_requests.push_back({fieldId, filepath, gridName});
+        }
+    }
+    m_requestsCV.notify_all();
+
+    // Grids of the frames the field moved past are left to the regular LRU eviction
+    UnpinVdbGrids(this, fieldId, fieldGrids);
+}
+
+void HdRprVdbGridPrefetcher::Release(SdfPath const& fieldId) {
+    Prefetch(fieldId, std::string(), {});
+}
+
+void HdRprVdbGridPrefetcher::ProcessRequests() {
+    while (true) {
+        Request request;
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_requestsCV.wait(lock, [this]() { return m_isStopped || !m_requests.empty(); });
+            if (m_isStopped) {
+                return;
+            }
+            request = std::move(m_requests.front());
+            m_requests.pop_front();
+        }
+
+        if (!CanPrefetchVdbGrid(request.filepath, request.gridName)) {
+            continue;
+        }
+        GetVdbGrid(request.filepath, request.gridName, request.fieldId, 1.0, nullptr, this, request.fieldId);
+
+        // The field could have moved past the frame while it was being read
+        std::set<GridId> fieldGrids;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            if (m_isStopped) {
+                return;
+            }
+
+            auto fieldIt = m_fieldGrids.find(request.fieldId);
+            if (fieldIt != m_fieldGrids.end()) {
+                if (fieldIt->second.count(GridId(request.filepath, request.gridName))) {
+                    continue;
+                }
+                fieldGrids = fieldIt->second;
+            }
+        }
+        UnpinVdbGrids(this, request.fieldId, fieldGrids);
+    }
+}
+
+void HdRprSetVdbGridCacheBudget(size_t numBytes) {
+    auto& cache = GetVdbGridCache();
+    std::lock_guard<std::mutex> lock(cache.mutex);
+    cache.budget = numBytes;
+    cache.EvictOverBudget(nullptr);
+}
+
+HdRprVdbGridCacheStats HdRprGetVdbGridCacheStats() {
+    auto& cache = GetVdbGridCache();
+    std::lock_guard<std::mutex> lock(cache.mutex);
+
+    HdRprVdbGridCacheStats stats;
+    stats.numGrids = cache.entries.size();
+    stats.numBytes = cache.numBytes;
+    stats.numHits = cache.numHits;
+    stats.numMisses = cache.numMisses;
+    return stats;
+}
+
+PXR_NAMESPACE_CLOSE_SCOPE
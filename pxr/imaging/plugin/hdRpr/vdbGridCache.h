@@ -0,0 +1,113 @@
+/************************************************************************
+Copyright 2020 Advanced Micro Devices, Inc
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+    http://www.apache.org/licenses/LICENSE-2.0
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+************************************************************************/
+
+#ifndef HDRPR_VDB_GRID_CACHE_H
+#define HDRPR_VDB_GRID_CACHE_H
+
+#include "pxr/usd/sdf/path.h"
+
+#include <openvdb/openvdb.h>
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+
+PXR_NAMESPACE_OPEN_SCOPE
+
+// Grid read from a .vdb file along with the metadata of the file
+struct HdRprVdbGrid {
+    openvdb::GridBase::ConstPtr grid;
+    openvdb::MetaMap::ConstPtr fileMetadata;
+};
+using HdRprVdbGridSharedPtr = std::shared_ptr<HdRprVdbGrid const>;
+
+// Returns grid from the process-wide cache, the grid is read from the file if it's not cached yet or the file was modified.
+// Returns nullptr if the grid could not be read
+HdRprVdbGridSharedPtr HdRprGetVdbGrid(
+    std::string const& filepath,
+    std::string const& gridName,
+    SdfPath const& id);
+
+using HdRprVdbGridResampler = std::function<openvdb::GridBase::Ptr(openvdb::GridBase const& grid, double voxelSizeScale)>;
+
+// Returns grid resampled to the voxel size scaled by voxelSizeScale from the process-wide cache.
+// The grid is resampled if it's not cached yet, resampled grids count towards the same budget and
+// are dropped along with the grids of the previous versions of the file.
+// Returns nullptr if the grid could not be read or resampled
+HdRprVdbGridSharedPtr HdRprGetResampledVdbGrid(
+    std::string const& filepath,
+    std::string const& gridName,
+    SdfPath const& id,
+    double voxelSizeScale,
+    HdRprVdbGridResampler const& resample);
+
+// Reads grids into the cache on background threads.
+// Prefetched grids are kept in the cache until they are requested or released by the prefetcher.
+// Pending requests are dropped, the threads are joined and all grids are released on destruction
+class HdRprVdbGridPrefetcher {
+public:
+    HdRprVdbGridPrefetcher() = default;
+    ~HdRprVdbGridPrefetcher();
+
+    // Prefetches the grid from the given files for the field, files that are already cached are skipped.
+    // Grids previously prefetched for the field from other files are released
+    void Prefetch(
+        SdfPath const& fieldId,
+        std::string const& gridName,
+        std::vector<std::string> const& filepaths);
+
+    // Releases all grids prefetched for the field, they stay in the cache until evicted
+    void Release(SdfPath const& fieldId);
+
+private:
+    void ProcessRequests();
+
+private:
+    struct Request {
+        SdfPath fieldId;
+        std::string filepath;
+        std::string gridName;
+    };
+
+    std::mutex m_mutex;
+    std::condition_variable m_requestsCV;
+    std::deque<Request> m_requests;
+    // File path and grid name of the grids currently wanted by each field
+    std::map<SdfPath, std::set<std::pair<std::string, std::string>>> m_fieldGrids;
+    std::vector<std::thread> m_threads;
+    bool m_isStopped = false;
+};
+
+// Least recently used grids are dropped from the cache when it exceeds the budget.
+// Grids that are currently used by volumes are kept alive by their users.
+// Prefetched grids are kept until they are requested or released, prefetching pauses while they fill the budget
+void HdRprSetVdbGridCacheBudget(size_t numBytes);
+
+struct HdRprVdbGridCacheStats {
+    size_t numGrids;
+    size_t numBytes;
+    size_t numHits;
+    size_t numMisses;
+};
+HdRprVdbGridCacheStats HdRprGetVdbGridCacheStats();
+
+PXR_NAMESPACE_CLOSE_SCOPE
+
+#endif // HDRPR_VDB_GRID_CACHE_H
@@ -18,8 +18,7 @@ using json = nlohmann::json;
 #include "field.h"
 #include "rprApi.h"
 #include "renderParam.h"
-
-#include "RPRLibs/pluginUtils.hpp"
+#include "vdbGridCache.h"
 
 #include "houdini/openvdb.h"
 
@@ -27,8 +26,14 @@ using json = nlohmann::json;
 #include "pxr/usd/sdf/assetPath.h"
 #include "pxr/usd/usdLux/blackbody.h"
 #include "pxr/usd/usdVol/tokens.h"
+#include "pxr/base/work/loops.h"
 
 #include <openvdb/openvdb.h>
+#include <openvdb/tree/LeafManager.h>
+#include <openvdb/tools/GridTransformer.h>
+
+#include <cmath>
+#include <limits>
 
 PXR_NAMESPACE_OPEN_SCOPE
 
@@ -187,7 +192,10 @@ T HdRprResampleRawTimeSamples(
 
 struct GridInfo {
     std::string filepath;
+    // Empty for in-memory grids that are not managed by the grid cache
+    std::string gridName;
     openvdb::FloatGrid const* vdbGrid = nullptr;
+    openvdb::MetaMap const* fileMetadata = nullptr;
     HdVolumeFieldDescriptor const* desc;
     GridParameters params;
 };
@@ -198,7 +206,7 @@ void ParseOpenvdbMetadata(GridInfo* grid) {
         static constexpr auto metadataParameters = GridParameters::kRampAuthored | GridParameters::kScaleAuthored;
         return (grid->params.authoredParamsMask & metadataParameters) == metadataParameters;
     };
-    if (isAllParametersParsed(grid)) {
+    if (!grid->fileMetadata || isAllParametersParsed(grid)) {
         return;
     }
 
@@ -212,125 +220,235 @@ void ParseOpenvdbMetadata(GridInfo* grid) {
     auto cdrampMd = metadataNamePrefix + "cdramp";
     auto scaleMd = metadataNamePrefix + "scale";
 
-    try {
-        openvdb::io::File file(grid->filepath);
-        file.open();
-
-        auto metadata = file.getMetadata();
-        for (auto it = metadata->beginMeta(); it != metadata->endMeta() && !isAllParametersParsed(grid); ++it) {
-            if (it->first == cdrampMd) {
-                if (grid->params.authoredParamsMask & GridParameters::kRampAuthored) {
-                    continue;
-                }
-
-                try {
-                    auto root = json::parse(it->second->str());
-                    if (root["colortype"] == "RGB") {
-                        auto points = root["points"];
-                        auto pointsIt = points.begin();
-
-                        // First element is always number of points
-                        int numPoints = pointsIt->get<int>();
-                        if (numPoints <= 0) {
-                            TF_RUNTIME_ERROR("Failed to parse openvdb metadata \"%s\": invalid %s - incorrect number of points %d", grid->filepath.c_str(), cdrampMd.c_str(), numPoints);
-                            continue;
-                        }
-                        ++pointsIt;
+    auto metadata = grid->fileMetadata;
+    for (auto it = metadata->beginMeta(); it != metadata->endMeta() && !isAllParametersParsed(grid); ++it) {
+        if (it->first == cdrampMd) {
+            if (grid->params.authoredParamsMask & GridParameters::kRampAuthored) {
+                continue;
+            }
 
-                        std::vector<float> parameters;
-                        std::vector<GfVec3f> colors;
+            try {
+                auto root = json::parse(it->second->str());
+                if (root["colortype"] == "RGB") {
+                    auto points = root["points"];
+                    auto pointsIt = points.begin();
+
+                    // First element is always number of points
+                    int numPoints = pointsIt->get<int>();
+                    if (numPoints <= 0) {
+                        TF_RUNTIME_ERROR("Failed to parse openvdb metadata \"%s\": invalid %s - incorrect number of points %d", grid->filepath.c_str(), cdrampMd.c_str(), numPoints);
+                        continue;
+                    }
+                    ++pointsIt;
 
-                        parameters.reserve(std::min(64, numPoints));
-                        colors.reserve(std::min(64, numPoints));
+                    std::vector<float> parameters;
+                    std::vector<GfVec3f> colors;
 
-                        for (; pointsIt != points.end(); ++pointsIt) {
-                            if (numPoints == 0) {
-                                TF_RUNTIME_ERROR("Failed to parse openvdb metadata \"%s\": invalid %s - excessive number of points", grid->filepath.c_str(), cdrampMd.c_str());
-                                continue;
-                            }
+                    parameters.reserve(std::min(64, numPoints));
+                    colors.reserve(std::min(64, numPoints));
 
-                            auto& point = (*pointsIt);
-                            parameters.push_back(point["t"].get<float>());
+                    for (; pointsIt != points.end(); ++pointsIt) {
+                        if (numPoints == 0) {
+                            TF_RUNTIME_ERROR("Failed to parse openvdb metadata \"%s\": invalid %s - excessive number of points", grid->filepath.c_str(), cdrampMd.c_str());
+                            continue;
+                        }
 
-                            GfVec3f color;
-                            auto rgba = point["rgba"];
-                            for (int i = 0; i < 3; ++i) {
-                                color[i] = rgba[i].get<float>();
-                            }
-                            colors.push_back(color);
+                        auto& point = (*pointsIt);
+                        parameters.push_back(point["t"].get<float>());
 
-                            numPoints--;
+                        GfVec3f color;
+                        auto rgba = point["rgba"];
+                        for (int i = 0; i < 3; ++i) {
+                            color[i] = rgba[i].get<float>();
                         }
+                        colors.push_back(color);
 
-                        if (numPoints != 0) {
-                            TF_RUNTIME_ERROR("Failed to parse openvdb metadata \"%s\": invalid %s - insufficient number of points", grid->filepath.c_str(), cdrampMd.c_str());
-                            continue;
-                        }
+                        numPoints--;
+                    }
 
-                        // RPR expects linearly interpolated ramp
-                        // Houdini's ramp is defined as parameter-color pair (the parameter is in [0; 1] range)
-                        // Here we convert arbitrarily distributed color ramp to a linear ramp
-                        auto& ramp = grid->params.ramp;
-                        ramp.reserve(kLookupTableGranularityLevel);
-                        for (int i = 0; i < kLookupTableGranularityLevel; ++i) {
-                            float t = static_cast<float>(i) / (kLookupTableGranularityLevel - 1);
-                            ramp.push_back(HdRprResampleRawTimeSamples(t, parameters.size(), parameters.data(), colors.data()));
-                        }
-                        grid->params.authoredParamsMask |= GridParameters::kRampAuthored;
+                    if (numPoints != 0) {
+                        TF_RUNTIME_ERROR("Failed to parse openvdb metadata \"%s\": invalid %s - insufficient number of points", grid->filepath.c_str(), cdrampMd.c_str());
+                        continue;
                     }
-                } catch (json::exception& e) {
-                    TF_RUNTIME_ERROR("Failed to parse openvdb metadata \"%s\": invalid %s - %s", grid->filepath.c_str(), cdrampMd.c_str(), e.what());
-                }
-            } else if (it->first == scaleMd) {
-                if (grid->params.authoredParamsMask & GridParameters::kScaleAuthored) {
-                    continue;
-                }
 
-                if (it->second->typeName() == "float") {
-                    try {
-                        grid->params.scale *= std::stof(it->second->str()) * 0.01f;
-                        grid->params.authoredParamsMask |= GridParameters::kScaleAuthored;
-                    } catch (std::exception& e) {
-                        TF_RUNTIME_ERROR("Failed to parse openvdb metadata \"%s\": invalid %s - %s", grid->filepath.c_str(), scaleMd.c_str(), e.what());
+                    // RPR expects linearly interpolated ramp
+                    // Houdini's ramp is defined as parameter-color pair (the parameter is in [0; 1] range)
+                    // Here we convert arbitrarily distributed color ramp to a linear ramp
+                    auto& ramp = grid->params.ramp;
+                    ramp.reserve(kLookupTableGranularityLevel);
+                    for (int i = 0; i < kLookupTableGranularityLevel; ++i) {
+                        float t = static_cast<float>(i) / (kLookupTableGranularityLevel - 1);
+                        ramp.push_back(HdRprResampleRawTimeSamples(t, parameters.size(), parameters.data(), colors.data()));
                     }
+                    grid->params.authoredParamsMask |= GridParameters::kRampAuthored;
+                }
+            } catch (json::exception& e) {
+                TF_RUNTIME_ERROR("Failed to parse openvdb metadata \"%s\": invalid %s - %s", grid->filepath.c_str(), cdrampMd.c_str(), e.what());
+            }
+        } else if (it->first == scaleMd) {
+            if (grid->params.authoredParamsMask & GridParameters::kScaleAuthored) {
+                continue;
+            }
+
+            if (it->second->typeName() == "float") {
+                try {
+                    grid->params.scale *= std::stof(it->second->str()) * 0.01f;
+                    grid->params.authoredParamsMask |= GridParameters::kScaleAuthored;
+                } catch (std::exception& e) {
+                    TF_RUNTIME_ERROR("Failed to parse openvdb metadata \"%s\": invalid %s - %s", grid->filepath.c_str(), scaleMd.c_str(), e.what());
                 }
             }
         }
-    } catch (openvdb::IoError const& e) {
-        TF_RUNTIME_ERROR("Failed to parse openvdb metadata \"%s\": %s", grid->filepath.c_str(), e.what());
     }
 }
 
-VDBGrid<float> CopyGridTopology(VDBGrid<float> const& from) {
+// Grid data ready to be passed to RPR
+struct RprGridData {
+    HdRprApiVolumeGridIndices indices;
+    VtFloatArray values;
+    float minValue = 0.0f;
+    float maxValue = 0.0f;
+};
+
+RprGridData CopyGridTopology(RprGridData const& from) {
     static const float kFillValue = 0.0f;
 
-    VDBGrid<float> newGrid;
-    newGrid.gridSizeX = from.gridSizeX;
-    newGrid.gridSizeY = from.gridSizeY;
-    newGrid.gridSizeZ = from.gridSizeZ;
-    newGrid.coords = from.coords;
+    RprGridData newGrid;
+    newGrid.indices = from.indices;
     newGrid.values = VtFloatArray(from.values.size(), kFillValue);
-    newGrid.LUT = from.LUT;
     newGrid.maxValue = kFillValue;
     newGrid.minValue = kFillValue;
 
     return newGrid;
 }
 
-void NormalizeGrid(VDBGrid<float>* grid) {
-    if ((GfIsClose(grid->minValue, 0.0f, 1e-3f) && GfIsClose(grid->maxValue, 1.0f, 1e-3f)) ||
-        GfIsClose(grid->minValue, grid->maxValue, 1e-6f)) {
-        return;
+// Converts active values of the grid into RPR grid data, voxels are addressed by linear indices relative to the bbox.
+// Active voxels and value range of each leaf are measured in parallel to find where each leaf starts in the output,
+// then leaves are converted in parallel. minValue and maxValue are set to the range of the source values
+void ConvertVdbGrid(
+    openvdb::FloatGrid const* grid,
+    openvdb::CoordBBox const& bbox,
+    bool normalize,
+    RprGridData* outGrid) {
+    auto& tree = grid->tree();
+    openvdb::tree::LeafManager<openvdb::FloatTree const> leafManager(tree);
+    size_t numLeaves = leafManager.leafCount();
+
+    // Active tiles are not stored in leaves, each of them is converted into a single voxel at the tile origin
+    std::vector<std::pair<openvdb::Coord, float>> activeTiles;
+    auto tileIt = tree.cbeginValueOn();
+    tileIt.setMaxDepth(openvdb::FloatTree::ValueOnCIter::LEAF_DEPTH - 1);
+    for (; tileIt; ++tileIt) {
+        activeTiles.emplace_back(tileIt.getCoord(), *tileIt);
+    }
+
+    std::vector<size_t> leafOffsets(numLeaves + 1, 0);
+    std::vector<float> leafMinValues(numLeaves);
+    std::vector<float> leafMaxValues(numLeaves);
+    WorkParallelForN(numLeaves,
+        [&](size_t begin, size_t end) {
+            for (size_t i = begin; i < end; ++i) {
+                auto& leaf = leafManager.leaf(i);
+                float minValue = std::numeric_limits<float>::max();
+                float maxValue = std::numeric_limits<float>::lowest();
+                for (auto it = leaf.cbeginValueOn(); it; ++it) {
+                    minValue = std::min(minValue, *it);
+                    maxValue = std::max(maxValue, *it);
+                }
+                leafOffsets[i + 1] = leaf.onVoxelCount();
+                leafMinValues[i] = minValue;
+                leafMaxValues[i] = maxValue;
+            }
+        }
+    );
+
+    float minValue = std::numeric_limits<float>::max();
+    float maxValue = std::numeric_limits<float>::lowest();
+    for (size_t i = 0; i < numLeaves; ++i) {
+        leafOffsets[i + 1] += leafOffsets[i];
+        minValue = std::min(minValue, leafMinValues[i]);
+        maxValue = std::max(maxValue, leafMaxValues[i]);
+    }
+    for (auto& tile : activeTiles) {
+        minValue = std::min(minValue, tile.second);
+        maxValue = std::max(maxValue, tile.second);
+    }
+
+    size_t numVoxels = leafOffsets[numLeaves] + activeTiles.size();
+    if (!numVoxels) {
+        minValue = 0.0f;
+        maxValue = 0.0f;
+    }
+
+    // Normalization is applied during the conversion instead of a separate pass over the values
+    float scale = 1.0f;
+    float offset = 0.0f;
+    if (normalize &&
+        !(GfIsClose(minValue, 0.0f, 1e-3f) && GfIsClose(maxValue, 1.0f, 1e-3f)) &&
+        !GfIsClose(minValue, maxValue, 1e-6f)) {
+        offset = -minValue;
+        scale = 1.0f / (maxValue - minValue);
     }
 
-    float offset = -grid->minValue;
-    float scale = 1.0f / (grid->maxValue - grid->minValue);
-    for (auto& value : grid->values) {
-        value = value * scale + offset;
+    // background value is not added by vdb automatically
+    float background = grid->background();
+    openvdb::Coord lowerBound = bbox.min();
+    uint64_t gridSizeX = bbox.dim().x();
+    uint64_t gridSizeXY = gridSizeX * bbox.dim().y();
+
+    // Linear indices take 4 or 8 bytes per voxel instead of 12 bytes of xyz coordinates
+    uint32_t* indices32 = nullptr;
+    uint64_t* indices64 = nullptr;
+    if (gridSizeXY * bbox.dim().z() <= std::numeric_limits<uint32_t>::max()) {
+        outGrid->indices.indices32.resize(numVoxels);
+        indices32 = outGrid->indices.indices32.data();
+    } else {
+        outGrid->indices.indices64.resize(numVoxels);
+        indices64 = outGrid->indices.indices64.data();
     }
 
-    grid->minValue = 0.0f;
-    grid->maxValue = 1.0f;
+    outGrid->values.resize(numVoxels);
+    auto values = outGrid->values.data();
+    auto writeVoxel = [&](size_t index, openvdb::Coord const& coord, float value) {
+        // for RPR negative voxel indices are invalid
+        uint64_t linearIndex = uint64_t(coord.x() - lowerBound.x()) +
+                               uint64_t(coord.y() - lowerBound.y()) * gridSizeX +
+                               uint64_t(coord.z() - lowerBound.z()) * gridSizeXY;
+        if (indices32) {
+            indices32[index] = uint32_t(linearIndex);
+        } else {
+            indices64[index] = linearIndex;
+        }
+        values[index] = (value + background) * scale + offset;
+    };
+
+    WorkParallelForN(numLeaves,
+        [&](size_t begin, size_t end) {
+            for (size_t i = begin; i < end; ++i) {
+                size_t index = leafOffsets[i];
+                for (auto it = leafManager.leaf(i).cbeginValueOn(); it; ++it) {
+                    writeVoxel(index++, it.getCoord(), *it);
+                }
+            }
+        }
+    );
+    for (size_t i = 0; i < activeTiles.size(); ++i) {
+        writeVoxel(leafOffsets[numLeaves] + i, activeTiles[i].first, activeTiles[i].second);
+    }
+
+    outGrid->minValue = minValue;
+    outGrid->maxValue = maxValue;
+}
+
+// Resamples the grid to the voxel size scaled by voxelSizeScale, the resampling is multithreaded by openvdb
+openvdb::FloatGrid::Ptr ResampleVdbGrid(openvdb::FloatGrid const& grid, double voxelSizeScale) {
+    auto transform = grid.transform().copy();
+    transform->preScale(voxelSizeScale);
+
+    auto resampledGrid = openvdb::FloatGrid::create(grid.background());
+    resampledGrid->setTransform(transform);
+    openvdb::tools::resampleToMatch<openvdb::tools::BoxSampler>(grid, *resampledGrid);
+    return resampledGrid;
 }
 
 bool IsInMemoryVdb(std::string const& filepath) {
@@ -372,41 +490,35 @@ void HdRprVolume::Sync(
         m_rprVolume = nullptr;
 
         openvdb::initialize();
-        std::map<std::string, openvdb::GridBase::Ptr> retainedVDBGrids;
+        HdRprSetVdbGridCacheBudget(size_t(rprApi->GetVolumeGridCacheBudgetMb()) << 20);
+
+        // Keeps the grids alive until the conversion is done even if they are dropped from the cache
+        std::vector<HdRprVdbGridSharedPtr> retainedVDBGrids;
 
-        auto getVdbGrid = [&](SdfPath const& fieldId, std::string const& openvdbPath) -> openvdb::FloatGrid const* {
+        auto getVdbGrid = [&](SdfPath const& fieldId, GridInfo* gridInfo) {
             auto fieldName = sceneDelegate->Get(fieldId, UsdVolTokens->fieldName).GetWithDefault(TfToken());
+            auto& openvdbPath = gridInfo->filepath;
             if (IsInMemoryVdb(openvdbPath)) {
                 auto houdiniGrid = HoudiniOpenvdbLoader::Instance().GetGrid(openvdbPath.c_str(), fieldName.GetText());
                 if (houdiniGrid->type() != openvdb::FloatGrid::gridType()) {
                     TF_RUNTIME_ERROR("[%s] Failed to read vdb grid \"%s\": RPR supports scalar fields only", id.GetName().c_str(), openvdbPath.c_str());
-                    return nullptr;
+                    return;
                 }
-                return static_cast<openvdb::FloatGrid const*>(houdiniGrid);
+                gridInfo->vdbGrid = static_cast<openvdb::FloatGrid const*>(houdiniGrid);
             } else {
-                auto gridId = openvdbPath + fieldName.GetString();
-                auto gridIter = retainedVDBGrids.find(gridId);
-                if (gridIter != retainedVDBGrids.end()) {
-                    return static_cast<openvdb::FloatGrid const*>(gridIter->second.get());
+                auto cachedGrid = HdRprGetVdbGrid(openvdbPath, fieldName.GetString(), id);
+                if (!cachedGrid) {
+                    return;
                 }
-
-                try {
-                    openvdb::io::File file(openvdbPath);
-                    file.open();
-                    auto grid = file.readGrid(fieldName.GetString());
-                    if (grid->type() != openvdb::FloatGrid::gridType()) {
-                        TF_RUNTIME_ERROR("[%s] Failed to read vdb grid from file \"%s\": RPR supports scalar fields only", id.GetName().c_str(), openvdbPath.c_str());
-                        return nullptr;
-                    }
-                    auto ret = static_cast<openvdb::FloatGrid const*>(grid.get());
-                    retainedVDBGrids[gridId] = std::move(grid);
-                    return ret;
-                } catch (openvdb::Exception const& e) {
-                    TF_RUNTIME_ERROR("[%s] Failed to read vdb grid from file \"%s\": %s", id.GetName().c_str(), openvdbPath.c_str(), e.what());
+                if (cachedGrid->grid->type() != openvdb::FloatGrid::gridType()) {
+                    TF_RUNTIME_ERROR("[%s] Failed to read vdb grid from file \"%s\": RPR supports scalar fields only", id.GetName().c_str(), openvdbPath.c_str());
+                    return;
                 }
+                gridInfo->vdbGrid = static_cast<openvdb::FloatGrid const*>(cachedGrid->grid.get());
+                gridInfo->fileMetadata = cachedGrid->fileMetadata.get();
+                gridInfo->gridName = fieldName.GetString();
+                retainedVDBGrids.push_back(std::move(cachedGrid));
             }
-
-            return nullptr;
         };
 
         decltype(m_fieldSubscriptions) activeFieldSubscriptions;
@@ -426,7 +538,7 @@ void HdRprVolume::Sync(
 
                 targetInfo.params = ParseGridParameters(sceneDelegate, desc.fieldId);
 
-                targetInfo.vdbGrid = getVdbGrid(desc.fieldId, targetInfo.filepath);
+                getVdbGrid(desc.fieldId, &targetInfo);
                 if (targetInfo.vdbGrid) {
                     ParseOpenvdbMetadata(&targetInfo);
 
@@ -471,6 +583,66 @@ void HdRprVolume::Sync(
         m_fieldSubscriptions.clear();
         std::swap(m_fieldSubscriptions, activeFieldSubscriptions);
 
+        // Grids over the voxel budget are downsampled, the voxel size and bounds of the volume are derived from the resampled grids.
+        // Resampled grids of .vdb files are kept in the grid cache so that parameter edits don't resample them again
+        std::map<std::pair<openvdb::FloatGrid const*, double>, openvdb::FloatGrid::Ptr> resampledInMemoryGrids;
+        if (size_t voxelBudget = rprApi->GetVolumeVoxelBudget()) {
+            auto resampleGrid = [&](GridInfo const& gridInfo, double voxelSizeScale) -> openvdb::FloatGrid const* {
+                if (gridInfo.gridName.empty()) {
+                    auto& resampledGrid = resampledInMemoryGrids[std::make_pair(gridInfo.vdbGrid, voxelSizeScale)];
+                    if (!resampledGrid) {
+                        resampledGrid = ResampleVdbGrid(*gridInfo.vdbGrid, voxelSizeScale);
+                    }
+                    return resampledGrid.get();
+                }
+
+                auto cachedGrid = HdRprGetResampledVdbGrid(gridInfo.filepath, gridInfo.gridName, id, voxelSizeScale,
+                    [](openvdb::GridBase const& grid, double voxelSizeScale) -> openvdb::GridBase::Ptr {
+                        return ResampleVdbGrid(static_cast<openvdb::FloatGrid const&>(grid), voxelSizeScale);
+                    }
+                );
+                if (!cachedGrid) {
+                    return nullptr;
+                }
+                auto resampledGrid = static_cast<openvdb::FloatGrid const*>(cachedGrid->grid.get());
+                retainedVDBGrids.push_back(std::move(cachedGrid));
+                return resampledGrid;
+            };
+
+            GridInfo* largestGridInfo = nullptr;
+            size_t numLargestGridVoxels = 0;
+            for (auto gridInfo : {&densityGridInfo, &emissionGridInfo, &albedoGridInfo}) {
+                if (gridInfo->vdbGrid && gridInfo->vdbGrid->tree().activeLeafVoxelCount() > numLargestGridVoxels) {
+                    largestGridInfo = gridInfo;
+                    numLargestGridVoxels = gridInfo->vdbGrid->tree().activeLeafVoxelCount();
+                }
+            }
+
+            if (numLargestGridVoxels > voxelBudget) {
+                // The number of voxels of dense grids scales with the cube of the voxel size, sparse grids shrink slower.
+                // Keep coarsening the largest grid until it fits the budget, every step is deterministic so cached grids are hit on the next syncs
+                static const int kMaxResampleIterations = 4;
+                double voxelSizeScale = 1.0;
+                size_t numVoxels = numLargestGridVoxels;
+                openvdb::FloatGrid const* resampledLargestGrid = nullptr;
+                for (int i = 0; i < kMaxResampleIterations && numVoxels > voxelBudget; ++i) {
+                    voxelSizeScale *= std::cbrt(double(numVoxels) / voxelBudget);
+                    resampledLargestGrid = resampleGrid(*largestGridInfo, voxelSizeScale);
+                    if (!resampledLargestGrid) {
+                        break;
+                    }
+                    numVoxels = resampledLargestGrid->tree().activeLeafVoxelCount();
+                }
+
+                for (auto gridInfo : {&densityGridInfo, &emissionGridInfo, &albedoGridInfo}) {
+                    if (gridInfo != largestGridInfo && gridInfo->vdbGrid) {
+                        gridInfo->vdbGrid = resampleGrid(*gridInfo, voxelSizeScale);
+                    }
+                }
+                largestGridInfo->vdbGrid = resampledLargestGrid;
+            }
+        }
+
         auto densityGrid = densityGridInfo.vdbGrid;
         auto emissionGrid = emissionGridInfo.vdbGrid;
         auto albedoGrid = albedoGridInfo.vdbGrid;
@@ -482,10 +654,10 @@ void HdRprVolume::Sync(
         }
 
         // If we need to read from both grids, check compatibility
-        if (densityGridInfo.vdbGrid && emissionGrid) {
-            if (densityGridInfo.vdbGrid->voxelSize() != emissionGrid->voxelSize())
+        if (densityGrid && emissionGrid) {
+            if (densityGrid->voxelSize() != emissionGrid->voxelSize())
                 TF_RUNTIME_ERROR("[Node: %s]: density grid and temperature grid differs in voxel sizes. Taking voxel size of density grid", GetId().GetName().c_str());
-            if (densityGridInfo.vdbGrid->transform() != emissionGrid->transform())
+            if (densityGrid->transform() != emissionGrid->transform())
                 TF_RUNTIME_ERROR("[Node: %s]: density grid and temperature grid have different transform. Taking transform of density grid", GetId().GetName().c_str());
         }
 
@@ -497,25 +669,22 @@ void HdRprVolume::Sync(
         if (albedoGrid) activeVoxelsBB.expand(albedoGrid->evalActiveVoxelBoundingBox());
         openvdb::Coord activeVoxelsBBSize = activeVoxelsBB.extents();
 
-        VDBGrid<float> densityGridData;
-        VDBGrid<float> emissionGridData;
-        VDBGrid<float> albedoGridData;
+        RprGridData densityGridData;
+        RprGridData emissionGridData;
+        RprGridData albedoGridData;
 
         if (densityGrid) {
-            ProcessVDBGrid(densityGridData, densityGridInfo.vdbGrid, activeVoxelsBB);
+            bool isRampAuthored = !densityGridInfo.params.ramp.empty();
+            if (!isRampAuthored && (densityGridInfo.params.authoredParamsMask & GridParameters::kNormalizeAuthored) == 0) {
+                densityGridInfo.params.normalize = true;
+            }
 
-            if (densityGridInfo.params.ramp.empty()) {
-                if ((densityGridInfo.params.authoredParamsMask & GridParameters::kNormalizeAuthored) == 0) {
-                    densityGridInfo.params.normalize = true;
-                }
+            ConvertVdbGrid(densityGrid, activeVoxelsBB, densityGridInfo.params.normalize, &densityGridData);
 
+            if (!isRampAuthored) {
                 densityGridInfo.params.ramp.push_back(GfVec3f(densityGridData.minValue));
                 densityGridInfo.params.ramp.push_back(GfVec3f(densityGridData.maxValue));
             }
-
-            if (densityGridInfo.params.normalize) {
-                NormalizeGrid(&densityGridData);
-            }
         }
 
         if (emissionGrid) {
@@ -542,24 +711,17 @@ void HdRprVolume::Sync(
                 emissionGridInfo.params.ramp.push_back(GfVec3f(1.0f));
             }
 
-            ProcessVDBGrid(emissionGridData, emissionGridInfo.vdbGrid, activeVoxelsBB);
-
-            if (emissionGridInfo.params.normalize) {
-                NormalizeGrid(&emissionGridData);
-            }
+            ConvertVdbGrid(emissionGrid, activeVoxelsBB, emissionGridInfo.params.normalize, &emissionGridData);
         }
 
         if (albedoGrid) {
-            ProcessVDBGrid(albedoGridData, albedoGridInfo.vdbGrid, activeVoxelsBB);
-            if (albedoGridInfo.params.normalize) {
-                NormalizeGrid(&albedoGridData);
-            }
+            ConvertVdbGrid(albedoGrid, activeVoxelsBB, albedoGridInfo.params.normalize, &albedoGridData);
             if (albedoGridInfo.params.ramp.empty()) {
                 albedoGridInfo.params.ramp.push_back(defaultColor);
             }
         }
 
-        if (densityGridData.coords.empty()) {
+        if (densityGridData.indices.empty()) {
             densityGridData = CopyGridTopology(emissionGridData);
             densityGridInfo.params.ramp.push_back(GfVec3f(defaultDensity));
         }
@@ -579,9 +741,9 @@ void HdRprVolume::Sync(
         GfVec3f voxelSizeGf(voxelSize.x(), voxelSize.y(), voxelSize.z());
 
         m_rprVolume = rprApi->CreateVolume(
-            densityGridData.coords, densityGridData.values, densityGridInfo.params.ramp, densityGridInfo.params.scale,
-            albedoGridData.coords, albedoGridData.values, albedoGridInfo.params.ramp, albedoGridInfo.params.scale, 
-            emissionGridData.coords, emissionGridData.values, emissionGridInfo.params.ramp, emissionGridInfo.params.scale,
+            densityGridData.indices, &densityGridData.values, densityGridInfo.params.ramp, densityGridInfo.params.scale,
+            albedoGridData.indices, albedoGridData.values, albedoGridInfo.params.ramp, albedoGridInfo.params.scale,
+            emissionGridData.indices, emissionGridData.values, emissionGridInfo.params.ramp, emissionGridInfo.params.scale,
             GfVec3i(activeVoxelsBBSize.asPointer()), voxelSizeGf, gridBBLow);
         newVolume = m_rprVolume != nullptr;
     }